@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "simd_impl.h"
+#include "format_utf8_impl.h"
+
+/**
+ * Locale independent ASCII string algorithms.
+ *
+ * Unlike <cctype>, only ASCII chars are classified/converted, all other
+ * bytes (e.g. UTF-8 sequences) are left untouched.
+ */
+namespace stx
+{
+
+namespace ascii_impl
+{
+
+inline bool is_space(char c)
+{
+    return c == ' ' || static_cast<unsigned char>(c - '\t') <= static_cast<unsigned char>('\r' - '\t');
+}
+
+inline char to_lower(char c)
+{
+    return static_cast<unsigned char>(c - 'A') <= 25u ? static_cast<char>(c | 0x20) : c;
+}
+
+inline char to_upper(char c)
+{
+    return static_cast<unsigned char>(c - 'a') <= 25u ? static_cast<char>(c & ~0x20) : c;
+}
+
+#if defined(STX_SIMD_SSE2)
+/* Signed compare trick: `first` .. `first` + 25 maps to -128 .. -103. */
+inline __m128i in_range(__m128i v, char first, char count)
+{
+    const auto shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(-128 - first)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + count)));
+}
+
+inline __m128i to_lower(__m128i v)
+{
+    return _mm_or_si128(v, _mm_and_si128(in_range(v, 'A', 26), _mm_set1_epi8(0x20)));
+}
+
+inline __m128i to_upper(__m128i v)
+{
+    return _mm_andnot_si128(_mm_and_si128(in_range(v, 'a', 26), _mm_set1_epi8(0x20)), v);
+}
+
+inline bool all_space(const char* p)
+{
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const auto space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), in_range(v, '\t', 5));
+    return _mm_movemask_epi8(space) == 0xffff;
+}
+#endif
+
+#if defined(STX_SIMD_AVX2)
+inline __m256i in_range(__m256i v, char first, char count)
+{
+    const auto shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(-128 - first)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + count)), shifted);
+}
+
+inline __m256i to_lower(__m256i v)
+{
+    return _mm256_or_si256(v, _mm256_and_si256(in_range(v, 'A', 26), _mm256_set1_epi8(0x20)));
+}
+
+inline __m256i to_upper(__m256i v)
+{
+    return _mm256_andnot_si256(_mm256_and_si256(in_range(v, 'a', 26), _mm256_set1_epi8(0x20)), v);
+}
+#endif
+
+#if defined(STX_SIMD_NEON)
+inline uint8x16_t to_lower(uint8x16_t v)
+{
+    const auto upper = vcleq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(25u));
+    return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20u)));
+}
+
+inline uint8x16_t to_upper(uint8x16_t v)
+{
+    const auto lower = vcleq_u8(vsubq_u8(v, vdupq_n_u8('a')), vdupq_n_u8(25u));
+    return vbicq_u8(v, vandq_u8(lower, vdupq_n_u8(0x20u)));
+}
+
+inline bool all_space(const char* p)
+{
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p));
+    const auto space = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                                vcleq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8('\r' - '\t')));
+    return vminvq_u8(space) == 0xffu;
+}
+#endif
+
+/**
+ * Case-convert `size` chars from `in` to `out` (which may equal `in`).
+ */
+template <bool _Upper>
+char* convert(const char* in, std::size_t size, char* out)
+{
+    std::size_t i = 0u;
+
+#if defined(STX_SIMD_AVX2)
+    for (; i + 32u <= size; i += 32u) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _Upper ? to_upper(v) : to_lower(v));
+    }
+#endif
+#if defined(STX_SIMD_SSE2)
+    for (; i + 16u <= size; i += 16u) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _Upper ? to_upper(v) : to_lower(v));
+    }
+#elif defined(STX_SIMD_NEON)
+    for (; i + 16u <= size; i += 16u) {
+        const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(in + i));
+        vst1q_u8(reinterpret_cast<std::uint8_t*>(out + i), _Upper ? to_upper(v) : to_lower(v));
+    }
+#endif
+
+    for (; i < size; ++i)
+        out[i] = _Upper ? to_upper(in[i]) : to_lower(in[i]);
+
+    return out + size;
+}
+
+template <bool _Upper, class _Iter>
+_Iter convert_to(_Iter out, std::string_view s)
+{
+    if constexpr (std::is_same_v<_Iter, char*>) {
+        return convert<_Upper>(s.data(), s.size(), out);
+    } else {
+        char buffer[256];
+        while (!s.empty()) {
+            const auto n = std::min(s.size(), sizeof(buffer));
+            out = std::copy(buffer, convert<_Upper>(s.data(), n, buffer), out);
+            s.remove_prefix(n);
+        }
+        return out;
+    }
+}
+
+}
+
+/**
+ * Returns `s` without leading ASCII whitespace (" \t\n\v\f\r").
+ */
+inline std::string_view trim_left(std::string_view s)
+{
+    std::size_t i = 0u;
+
+#if defined(STX_SIMD_SSE2) || defined(STX_SIMD_NEON)
+    while (i + 16u <= s.size() && ascii_impl::all_space(s.data() + i))
+        i += 16u;
+#endif
+
+    while (i < s.size() && ascii_impl::is_space(s[i]))
+        ++i;
+
+    return s.substr(i);
+}
+
+/**
+ * Returns `s` without trailing ASCII whitespace.
+ */
+inline std::string_view trim_right(std::string_view s)
+{
+    auto n = s.size();
+
+#if defined(STX_SIMD_SSE2) || defined(STX_SIMD_NEON)
+    while (n >= 16u && ascii_impl::all_space(s.data() + n - 16u))
+        n -= 16u;
+#endif
+
+    while (n > 0u && ascii_impl::is_space(s[n - 1u]))
+        --n;
+
+    return s.substr(0u, n);
+}
+
+/**
+ * Returns `s` without leading and trailing ASCII whitespace.
+ *
+ * Example:
+ *   for (auto token : split<std::vector<std::string_view>>(line, ","))
+ *       use(trim(token));
+ */
+inline std::string_view trim(std::string_view s)
+{
+    return trim_right(trim_left(s));
+}
+
+/**
+ * Write `s` with ASCII letters converted to lower case to `out`.
+ * Returns the iterator behind the last written char.
+ */
+template <class _Iter>
+_Iter to_lower_to(_Iter out, std::string_view s)
+{
+    return ascii_impl::convert_to<false>(out, s);
+}
+
+/**
+ * See `to_lower_to`.
+ */
+template <class _Iter>
+_Iter to_upper_to(_Iter out, std::string_view s)
+{
+    return ascii_impl::convert_to<true>(out, s);
+}
+
+/**
+ * Returns `s` with ASCII letters converted to lower case.
+ *
+ * The result type can be changed using `_String`, e.g.
+ * `to_lower<std::pmr::string>(s, &arena)`.
+ */
+template <class _String = std::string>
+_String to_lower(std::string_view s, const typename _String::allocator_type& alloc = {})
+{
+    _String str(s.size(), '\0', alloc);
+    ascii_impl::convert<false>(s.data(), s.size(), &str[0]);
+    return str;
+}
+
+/**
+ * See `to_lower`.
+ */
+template <class _String = std::string>
+_String to_upper(std::string_view s, const typename _String::allocator_type& alloc = {})
+{
+    _String str(s.size(), '\0', alloc);
+    ascii_impl::convert<true>(s.data(), s.size(), &str[0]);
+    return str;
+}
+
+/**
+ * Convert ASCII letters of string `s` to lower case in place.
+ */
+template <class _String>
+_String& to_lower_in_place(_String& s)
+{
+    ascii_impl::convert<false>(s.data(), s.size(), &s[0]);
+    return s;
+}
+
+/**
+ * See `to_lower_in_place`.
+ */
+template <class _String>
+_String& to_upper_in_place(_String& s)
+{
+    ascii_impl::convert<true>(s.data(), s.size(), &s[0]);
+    return s;
+}
+
+/**
+ * Returns true if all chars of `s` are 7 bit ASCII.
+ */
+inline bool is_ascii(std::string_view s)
+{
+    return format_impl::is_ascii(s);
+}
+
+/**
+ * ASCII case-insensitive comparison.
+ */
+inline bool iequals(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    std::size_t i = 0u;
+
+#if defined(STX_SIMD_SSE2)
+    for (; i + 16u <= a.size(); i += 16u) {
+        const auto va = ascii_impl::to_lower(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data() + i)));
+        const auto vb = ascii_impl::to_lower(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff)
+            return false;
+    }
+#elif defined(STX_SIMD_NEON)
+    for (; i + 16u <= a.size(); i += 16u) {
+        const auto va = ascii_impl::to_lower(vld1q_u8(reinterpret_cast<const std::uint8_t*>(a.data() + i)));
+        const auto vb = ascii_impl::to_lower(vld1q_u8(reinterpret_cast<const std::uint8_t*>(b.data() + i)));
+        if (vminvq_u8(vceqq_u8(va, vb)) != 0xffu)
+            return false;
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        if (ascii_impl::to_lower(a[i]) != ascii_impl::to_lower(b[i]))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * ASCII case-insensitive `starts_with`.
+ */
+inline bool starts_with_ci(std::string_view s, std::string_view prefix)
+{
+    return s.size() >= prefix.size() && iequals(s.substr(0u, prefix.size()), prefix);
+}
+
+/**
+ * ASCII case-insensitive `ends_with`.
+ */
+inline bool ends_with_ci(std::string_view s, std::string_view suffix)
+{
+    return s.size() >= suffix.size() && iequals(s.substr(s.size() - suffix.size()), suffix);
+}
+
+}
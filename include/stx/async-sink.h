@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include "format.h"
+#include "io_impl.h"
+
+namespace stx
+{
+
+/**
+ * Behaviour of `async_sink::write` if the ring buffer is full.
+ */
+enum class backpressure
+{
+    block, /* Wait for free space. Messages larger than the ring buffer
+            * are written by the calling thread. */
+    drop,  /* Drop the message. */
+    count  /* Drop the message, the sink writes a notice with the number
+            * of dropped messages as soon as there is space again. */
+};
+
+/**
+ * Asynchronous writer to a file descriptor.
+ *
+ * Producers format messages straight into slots of a lock-free,
+ * multi-producer/single-consumer ring buffer (no allocation per message).
+ * A background thread writes committed messages in batches, using writev.
+ *
+ * Messages of one thread are written in order; messages are written as
+ * is, add a line break to the format string if required.
+ *
+ * Messages are formatted once into a stack buffer and copied into their
+ * slot; messages longer than 256 chars are formatted twice (measuring
+ * and writing). Messages larger than the ring buffer are dropped, or
+ * with `backpressure::block` written by the calling thread once all
+ * messages enqueued before are written (allocating if formatted).
+ *
+ * Example:
+ *   stx::async_sink log(STDERR_FILENO);
+ *   log.write("{} {}: {}\n", now, level, message);
+ *
+ * Note: Requires linking Threads::Threads.
+ */
+class async_sink
+{
+public:
+    /**
+     * @param fd        Target file descriptor; not closed by the sink.
+     * @param capacity  Ring buffer size in bytes (rounded up to a power of two),
+     *                  messages larger than that bypass the ring buffer.
+     * @param policy    Behaviour if the ring buffer is full.
+     */
+    explicit async_sink(int fd,
+                        std::size_t capacity = 1u << 20,
+                        backpressure policy = backpressure::block)
+        : fd_(fd)
+        , policy_(policy)
+    {
+        capacity_ = 4096u;
+        while (capacity_ < capacity)
+            capacity_ <<= 1u;
+
+        words_ = std::make_unique<std::uint64_t[]>(capacity_ / sizeof(std::uint64_t));
+        consumer_ = std::thread([this] { consume(); });
+    }
+
+    async_sink(const async_sink&) = delete;
+    async_sink& operator=(const async_sink&) = delete;
+
+    /**
+     * Writes all pending messages and stops the background thread.
+     */
+    ~async_sink()
+    {
+        stop_.store(true, std::memory_order_release);
+        consumer_.join();
+    }
+
+    /**
+     * Format and enqueue a message. See `stx::format`.
+     *
+     * Returns false if the message was dropped.
+     */
+    template <class... _Args>
+    bool write(std::string_view fmt, const _Args& ...args)
+    {
+        char buffer[256];
+        const auto size = format_to_n(buffer, sizeof(buffer), fmt, args...).size;
+        if (size <= sizeof(buffer))
+            return write_raw(std::string_view(buffer, size));
+
+        if (footprint(size) > capacity_ && policy_ == backpressure::block)
+            return write_direct(stx::format(fmt, args...));
+
+        auto* slot = reserve(size);
+        if (!slot)
+            return false;
+
+        format_to(slot, fmt, args...);
+        commit(slot, size);
+        return true;
+    }
+
+    /**
+     * Enqueue an unformatted message.
+     */
+    bool write_raw(std::string_view message)
+    {
+        if (footprint(message.size()) > capacity_ && policy_ == backpressure::block)
+            return write_direct(message);
+
+        auto* slot = reserve(message.size());
+        if (!slot)
+            return message.empty();
+
+        std::memcpy(slot, message.data(), message.size());
+        commit(slot, message.size());
+        return true;
+    }
+
+    /**
+     * Blocks until all messages enqueued before the call are written.
+     */
+    void flush()
+    {
+        const auto target = write_pos_.load(std::memory_order_acquire);
+        while (read_pos_.load(std::memory_order_acquire) < target)
+            std::this_thread::yield();
+    }
+
+    /**
+     * Total number of dropped messages.
+     */
+    std::size_t dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns false if writing to the file descriptor failed.
+     */
+    bool good() const
+    {
+        return good_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /* Record header: (size << 2) | flags, 0 if not yet committed. */
+    static constexpr std::uint64_t committed = 1u;
+    static constexpr std::uint64_t padding = 2u;
+    static constexpr std::size_t header_size = sizeof(std::uint64_t);
+    static constexpr std::size_t max_batch = 64u;
+
+    static std::size_t footprint(std::size_t size)
+    {
+        return header_size + ((size + header_size - 1u) & ~(header_size - 1u));
+    }
+
+    std::atomic<std::uint64_t>& header(std::uint64_t pos) const
+    {
+        static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t));
+        return *reinterpret_cast<std::atomic<std::uint64_t>*>(&words_[(pos & (capacity_ - 1u)) / sizeof(std::uint64_t)]);
+    }
+
+    char* payload(std::uint64_t pos) const
+    {
+        return reinterpret_cast<char*>(&words_[(pos & (capacity_ - 1u)) / sizeof(std::uint64_t) + 1u]);
+    }
+
+    /**
+     * Reserve `size` bytes, returns the payload pointer or nullptr
+     * if the message is empty or dropped.
+     */
+    char* reserve(std::size_t size)
+    {
+        if (size == 0u)
+            return nullptr;
+
+        const auto need = footprint(size);
+        if (need > capacity_) {
+            drop();
+            return nullptr;
+        }
+
+        auto pos = write_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            const auto tail = capacity_ - (pos & (capacity_ - 1u));
+
+            /* Records are contiguous; fill the tail with a padding record if needed. */
+            const auto reserved = need > tail ? tail : need;
+            const auto read = read_pos_.load(std::memory_order_acquire);
+            if (read > pos) {
+                /* Stale position, the consumer already passed it. */
+                pos = write_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (pos + reserved - read > capacity_) {
+                if (policy_ != backpressure::block) {
+                    drop();
+                    return nullptr;
+                }
+
+                std::this_thread::yield();
+                pos = write_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (!write_pos_.compare_exchange_weak(pos, pos + reserved, std::memory_order_relaxed))
+                continue;
+
+            if (reserved != need) {
+                header(pos).store((tail << 2u) | padding | committed, std::memory_order_release);
+                pos += reserved;
+                continue;
+            }
+
+            return payload(pos);
+        }
+    }
+
+    /* Messages larger than the ring buffer, with backpressure::block. */
+    bool write_direct(std::string_view message)
+    {
+        flush();
+
+        const io_impl::buffer buffer{message.data(), message.size()};
+        if (!io_impl::write_all(fd_, &buffer, 1u))
+            good_.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    void commit(char* slot, std::size_t size)
+    {
+        auto& h = *reinterpret_cast<std::atomic<std::uint64_t>*>(slot - header_size);
+        h.store((static_cast<std::uint64_t>(size) << 2u) | committed, std::memory_order_release);
+    }
+
+    void drop()
+    {
+        dropped_.fetch_add(1u, std::memory_order_relaxed);
+        if (policy_ == backpressure::count)
+            unreported_.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    void consume()
+    {
+        io_impl::buffer batch[max_batch + 1u];
+        char notice[64];
+        auto idle = std::chrono::microseconds(1);
+
+        for (;;) {
+            /* Read stop flag before collecting, so no message gets lost. */
+            const auto stop = stop_.load(std::memory_order_acquire);
+
+            auto pos = read_pos_.load(std::memory_order_relaxed);
+            const auto begin = pos;
+            std::size_t count = 0u;
+
+            if (const auto n = unreported_.exchange(0u, std::memory_order_relaxed)) {
+                const auto r = format_to_n(notice, sizeof(notice), "[{} messages dropped]\n", n);
+                batch[count++] = {notice, std::min(r.size, sizeof(notice))};
+            }
+
+            /* A full ring wraps around to `begin`, which is not yet released. */
+            while (count < max_batch && pos - begin < capacity_) {
+                const auto h = header(pos).load(std::memory_order_acquire);
+                if (!(h & committed))
+                    break;
+
+                const auto size = static_cast<std::size_t>(h >> 2u);
+                if (h & padding) {
+                    pos += size;
+                    continue;
+                }
+
+                batch[count++] = {payload(pos), size};
+                pos += footprint(size);
+            }
+
+            if (count > 0u && !io_impl::write_all(fd_, batch, count))
+                good_.store(false, std::memory_order_relaxed);
+
+            if (pos != begin) {
+                /* Each consumed word might be a future record header, reset them to 0 (= not committed). */
+                release(begin, pos);
+                idle = std::chrono::microseconds(1);
+                continue;
+            }
+
+            if (stop)
+                break;
+
+            std::this_thread::sleep_for(idle);
+            idle = std::min<std::chrono::microseconds>(idle * 2, std::chrono::microseconds(1000));
+        }
+    }
+
+    /* Words are accessed as atomic headers, so they are cleared as such. */
+    void release(std::uint64_t begin, std::uint64_t end)
+    {
+        for (auto pos = begin; pos != end; pos += header_size)
+            header(pos).store(0u, std::memory_order_relaxed);
+
+        read_pos_.store(end, std::memory_order_release);
+    }
+
+    int fd_;
+    backpressure policy_;
+    std::size_t capacity_;
+    std::unique_ptr<std::uint64_t[]> words_;
+
+    alignas(64) std::atomic<std::uint64_t> write_pos_{0u};
+    alignas(64) std::atomic<std::uint64_t> read_pos_{0u};
+    alignas(64) std::atomic<std::size_t> dropped_{0u};
+    std::atomic<std::size_t> unreported_{0u};
+    std::atomic<bool> good_{true};
+    std::atomic<bool> stop_{false};
+    std::thread consumer_;
+};
+
+}
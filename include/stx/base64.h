@@ -0,0 +1,537 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "simd_impl.h"
+
+namespace stx
+{
+
+/**
+ * Base64 alphabets (RFC 4648).
+ */
+enum class base64_alphabet
+{
+    standard, /* A-Z a-z 0-9 + / */
+    url       /* A-Z a-z 0-9 - _ */
+};
+
+namespace base64_impl
+{
+
+inline const char* charset(base64_alphabet alphabet)
+{
+    return alphabet == base64_alphabet::url
+        ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+        : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+}
+
+constexpr std::uint8_t invalid = 0xffu;
+
+/**
+ * Char to 6 bit value table, `invalid` for chars not in the alphabet.
+ */
+constexpr std::array<std::uint8_t, 256> make_decode_table(char c62, char c63)
+{
+    std::array<std::uint8_t, 256> table{};
+    for (auto& v : table)
+        v = invalid;
+
+    for (int i = 0; i < 26; ++i) {
+        table['A' + i] = static_cast<std::uint8_t>(i);
+        table['a' + i] = static_cast<std::uint8_t>(26 + i);
+    }
+    for (int i = 0; i < 10; ++i)
+        table['0' + i] = static_cast<std::uint8_t>(52 + i);
+
+    table[static_cast<std::uint8_t>(c62)] = 62u;
+    table[static_cast<std::uint8_t>(c63)] = 63u;
+    return table;
+}
+
+inline const std::uint8_t* decode_table(base64_alphabet alphabet)
+{
+    static constexpr auto standard = make_decode_table('+', '/');
+    static constexpr auto url = make_decode_table('-', '_');
+    return alphabet == base64_alphabet::url ? url.data() : standard.data();
+}
+
+#if defined(STX_SIMD_SSSE3)
+/**
+ * Split 12 bytes (in the lower 12 bytes of each 16 byte lane, shuffled
+ * into 4 times 3 bytes) into 16 6 bit indices and translate them to
+ * ASCII. See Wojciech Muła, "Base64 encoding with SIMD instructions".
+ */
+inline __m128i encode_lane(__m128i in, __m128i shift_lut)
+{
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+    const auto t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const auto t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const auto t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const auto t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const auto indices = _mm_or_si128(t1, t3);
+
+    /* 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12 */
+    auto shift = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    shift = _mm_or_si128(shift, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(shift_lut, shift));
+}
+
+inline __m128i encode_shift_lut(base64_alphabet alphabet)
+{
+    const auto c62 = static_cast<char>((alphabet == base64_alphabet::url ? '-' : '+') - 62);
+    const auto c63 = static_cast<char>((alphabet == base64_alphabet::url ? '_' : '/') - 63);
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0);
+}
+
+/**
+ * Translate 16 chars to 6 bit values and pack them into 12 bytes
+ * (the upper 4 bytes of the result are zero). Returns false if
+ * any char is not part of the standard alphabet.
+ * See Wojciech Muła, "Base64 decoding with SIMD instructions".
+ */
+inline bool decode_lane(__m128i& in)
+{
+    const auto lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const auto lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const auto lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                        0, 0, 0, 0, 0, 0, 0, 0);
+    const auto mask_2f = _mm_set1_epi8(0x2f);
+
+    const auto hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+    const auto lo_nibbles = _mm_and_si128(in, mask_2f);
+    const auto hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    const auto lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())))
+        return false;
+
+    const auto eq_2f = _mm_cmpeq_epi8(in, mask_2f);
+    const auto roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+    in = _mm_add_epi8(in, roll);
+
+    const auto merged = _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140)),
+                                       _mm_set1_epi32(0x00011000));
+    in = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return true;
+}
+
+/**
+ * Map the URL alphabet's '-' and '_' to '+' and '/'.
+ * Returns false if `in` contains '+' or '/'.
+ */
+inline bool url_to_standard(__m128i& in)
+{
+    const auto bad = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('+')), _mm_cmpeq_epi8(in, _mm_set1_epi8('/')));
+    if (_mm_movemask_epi8(bad))
+        return false;
+
+    const auto minus = _mm_cmpeq_epi8(in, _mm_set1_epi8('-'));
+    const auto underscore = _mm_cmpeq_epi8(in, _mm_set1_epi8('_'));
+    in = _mm_andnot_si128(_mm_or_si128(minus, underscore), in);
+    in = _mm_or_si128(in, _mm_and_si128(minus, _mm_set1_epi8('+')));
+    in = _mm_or_si128(in, _mm_and_si128(underscore, _mm_set1_epi8('/')));
+    return true;
+}
+#endif
+
+#if defined(STX_SIMD_AVX2)
+inline __m256i broadcast(__m128i v)
+{
+    return _mm256_broadcastsi128_si256(v);
+}
+
+inline __m256i encode_lanes(__m256i in, __m256i shift_lut)
+{
+    in = _mm256_shuffle_epi8(in, broadcast(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1)));
+
+    const auto t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const auto t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const auto t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const auto t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const auto indices = _mm256_or_si256(t1, t3);
+
+    auto shift = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+
+    return _mm256_add_epi8(indices, _mm256_shuffle_epi8(shift_lut, shift));
+}
+
+inline bool decode_lanes(__m256i& in)
+{
+    const auto lut_lo = broadcast(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a));
+    const auto lut_hi = broadcast(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10));
+    const auto lut_roll = broadcast(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                                  0, 0, 0, 0, 0, 0, 0, 0));
+    const auto mask_2f = _mm256_set1_epi8(0x2f);
+
+    const auto hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_2f);
+    const auto lo_nibbles = _mm256_and_si256(in, mask_2f);
+    const auto hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    const auto lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())))
+        return false;
+
+    const auto eq_2f = _mm256_cmpeq_epi8(in, mask_2f);
+    const auto roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    in = _mm256_add_epi8(in, roll);
+
+    const auto merged = _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140)),
+                                          _mm256_set1_epi32(0x00011000));
+    in = _mm256_shuffle_epi8(merged, broadcast(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+    /* Pack the 12 bytes of both lanes. */
+    in = _mm256_permutevar8x32_epi32(in, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    return true;
+}
+
+inline bool url_to_standard(__m256i& in)
+{
+    const auto bad = _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('+')), _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')));
+    if (_mm256_movemask_epi8(bad))
+        return false;
+
+    const auto minus = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('-'));
+    const auto underscore = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('_'));
+    in = _mm256_andnot_si256(_mm256_or_si256(minus, underscore), in);
+    in = _mm256_or_si256(in, _mm256_and_si256(minus, _mm256_set1_epi8('+')));
+    in = _mm256_or_si256(in, _mm256_and_si256(underscore, _mm256_set1_epi8('/')));
+    return true;
+}
+#endif
+
+/**
+ * Encode `size` bytes from `in` to `out`, which must have room for
+ * `base64_encoded_size(size, pad)` chars. Returns the end of the output.
+ */
+inline char* encode(const std::uint8_t* in, std::size_t size, char* out, base64_alphabet alphabet, bool pad)
+{
+    const auto* end = in + size;
+
+#if defined(STX_SIMD_SSSE3)
+    const auto shift_lut = encode_shift_lut(alphabet);
+#  if defined(STX_SIMD_AVX2)
+    const auto shift_lut2 = broadcast(shift_lut);
+    /* Two 16 byte loads at +0 and +12; each lane uses 12 bytes. */
+    while (end - in >= 28) {
+        const auto v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), encode_lanes(v, shift_lut2));
+        in += 24;
+        out += 32;
+    }
+#  endif
+    while (end - in >= 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), encode_lane(v, shift_lut));
+        in += 12;
+        out += 16;
+    }
+#elif defined(STX_SIMD_NEON)
+    {
+        uint8x16x4_t table;
+        const auto* chars = reinterpret_cast<const std::uint8_t*>(charset(alphabet));
+        table.val[0] = vld1q_u8(chars);
+        table.val[1] = vld1q_u8(chars + 16);
+        table.val[2] = vld1q_u8(chars + 32);
+        table.val[3] = vld1q_u8(chars + 48);
+
+        const auto mask_3f = vdupq_n_u8(0x3fu);
+        while (end - in >= 48) {
+            const auto v = vld3q_u8(in);
+            uint8x16x4_t indices;
+            indices.val[0] = vshrq_n_u8(v.val[0], 2);
+            indices.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(v.val[0], 4), vshrq_n_u8(v.val[1], 4)), mask_3f);
+            indices.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(v.val[1], 2), vshrq_n_u8(v.val[2], 6)), mask_3f);
+            indices.val[3] = vandq_u8(v.val[2], mask_3f);
+
+            uint8x16x4_t chars4;
+            chars4.val[0] = vqtbl4q_u8(table, indices.val[0]);
+            chars4.val[1] = vqtbl4q_u8(table, indices.val[1]);
+            chars4.val[2] = vqtbl4q_u8(table, indices.val[2]);
+            chars4.val[3] = vqtbl4q_u8(table, indices.val[3]);
+            vst4q_u8(reinterpret_cast<std::uint8_t*>(out), chars4);
+
+            in += 48;
+            out += 64;
+        }
+    }
+#endif
+
+    const auto* chars = charset(alphabet);
+    while (end - in >= 3) {
+        const auto v = (std::uint32_t(in[0]) << 16) | (std::uint32_t(in[1]) << 8) | in[2];
+        out[0] = chars[(v >> 18) & 0x3f];
+        out[1] = chars[(v >> 12) & 0x3f];
+        out[2] = chars[(v >> 6) & 0x3f];
+        out[3] = chars[v & 0x3f];
+        in += 3;
+        out += 4;
+    }
+
+    if (end - in == 1) {
+        const auto v = std::uint32_t(in[0]) << 16;
+        *out++ = chars[(v >> 18) & 0x3f];
+        *out++ = chars[(v >> 12) & 0x3f];
+        if (pad) {
+            *out++ = '=';
+            *out++ = '=';
+        }
+    } else if (end - in == 2) {
+        const auto v = (std::uint32_t(in[0]) << 16) | (std::uint32_t(in[1]) << 8);
+        *out++ = chars[(v >> 18) & 0x3f];
+        *out++ = chars[(v >> 12) & 0x3f];
+        *out++ = chars[(v >> 6) & 0x3f];
+        if (pad)
+            *out++ = '=';
+    }
+
+    return out;
+}
+
+/**
+ * Decode `size` chars from `in` to `out`, which must have room for
+ * `base64_decoded_size` bytes. Padding is only accepted if `final`.
+ * Returns the end of the output, or nullptr if the input is invalid.
+ */
+inline std::uint8_t* decode(const char* in, std::size_t size, std::uint8_t* out, base64_alphabet alphabet, bool final)
+{
+    if (final && size > 0u && in[size - 1u] == '=') {
+        if (size % 4u != 0u)
+            return nullptr;
+        size -= (size >= 2u && in[size - 2u] == '=') ? 2u : 1u;
+    }
+
+    if (size % 4u == 1u)
+        return nullptr;
+
+    const auto* end = in + size;
+
+#if defined(STX_SIMD_SSSE3)
+    /* Stores write 16 (32) bytes, of which 12 (24) are valid; leave
+     * enough input for the remaining output. Invalid chars (including
+     * padding) end the vectorized loop, the scalar loop reports them. */
+#  if defined(STX_SIMD_AVX2)
+    while (end - in >= 48) {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        if (alphabet == base64_alphabet::url && !url_to_standard(v))
+            break;
+        if (!decode_lanes(v))
+            break;
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+        in += 32;
+        out += 24;
+    }
+#  endif
+    while (end - in >= 24) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        if (alphabet == base64_alphabet::url && !url_to_standard(v))
+            break;
+        if (!decode_lane(v))
+            break;
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+        in += 16;
+        out += 12;
+    }
+#elif defined(STX_SIMD_NEON)
+    {
+        const auto* table = decode_table(alphabet);
+        const uint8x16x4_t lo = {{vld1q_u8(table), vld1q_u8(table + 16), vld1q_u8(table + 32), vld1q_u8(table + 48)}};
+        const uint8x16x4_t hi = {{vld1q_u8(table + 64), vld1q_u8(table + 80), vld1q_u8(table + 96), vld1q_u8(table + 112)}};
+        const auto offset = vdupq_n_u8(64u);
+
+        while (end - in >= 64) {
+            const auto v = vld4q_u8(reinterpret_cast<const std::uint8_t*>(in));
+
+            /* Chars >= 128 are not covered by the tables, check them separately. */
+            auto d0 = vqtbx4q_u8(vqtbl4q_u8(lo, v.val[0]), hi, vsubq_u8(v.val[0], offset));
+            auto d1 = vqtbx4q_u8(vqtbl4q_u8(lo, v.val[1]), hi, vsubq_u8(v.val[1], offset));
+            auto d2 = vqtbx4q_u8(vqtbl4q_u8(lo, v.val[2]), hi, vsubq_u8(v.val[2], offset));
+            auto d3 = vqtbx4q_u8(vqtbl4q_u8(lo, v.val[3]), hi, vsubq_u8(v.val[3], offset));
+
+            const auto error = vorrq_u8(vorrq_u8(vorrq_u8(d0, d1), vorrq_u8(d2, d3)),
+                                        vorrq_u8(vorrq_u8(v.val[0], v.val[1]), vorrq_u8(v.val[2], v.val[3])));
+            if (vmaxvq_u8(error) & 0x80u)
+                break;
+
+            uint8x16x3_t bytes;
+            bytes.val[0] = vorrq_u8(vshlq_n_u8(d0, 2), vshrq_n_u8(d1, 4));
+            bytes.val[1] = vorrq_u8(vshlq_n_u8(d1, 4), vshrq_n_u8(d2, 2));
+            bytes.val[2] = vorrq_u8(vshlq_n_u8(d2, 6), d3);
+            vst3q_u8(out, bytes);
+
+            in += 64;
+            out += 48;
+        }
+    }
+#endif
+
+    const auto* table = decode_table(alphabet);
+    while (end - in >= 4) {
+        const auto a = table[static_cast<std::uint8_t>(in[0])];
+        const auto b = table[static_cast<std::uint8_t>(in[1])];
+        const auto c = table[static_cast<std::uint8_t>(in[2])];
+        const auto d = table[static_cast<std::uint8_t>(in[3])];
+        if ((a | b | c | d) & 0xc0u)
+            return nullptr;
+
+        const auto v = (std::uint32_t(a) << 18) | (std::uint32_t(b) << 12) | (std::uint32_t(c) << 6) | d;
+        out[0] = static_cast<std::uint8_t>(v >> 16);
+        out[1] = static_cast<std::uint8_t>(v >> 8);
+        out[2] = static_cast<std::uint8_t>(v);
+        in += 4;
+        out += 3;
+    }
+
+    if (end - in >= 2) {
+        const auto a = table[static_cast<std::uint8_t>(in[0])];
+        const auto b = table[static_cast<std::uint8_t>(in[1])];
+        const auto c = end - in == 3 ? table[static_cast<std::uint8_t>(in[2])] : std::uint8_t(0u);
+        if ((a | b | c) & 0xc0u)
+            return nullptr;
+
+        const auto v = (std::uint32_t(a) << 18) | (std::uint32_t(b) << 12) | (std::uint32_t(c) << 6);
+        *out++ = static_cast<std::uint8_t>(v >> 16);
+        if (end - in == 3)
+            *out++ = static_cast<std::uint8_t>(v >> 8);
+    }
+
+    return out;
+}
+
+}
+
+/**
+ * Number of chars of the base64 encoding of `size` bytes.
+ */
+constexpr std::size_t base64_encoded_size(std::size_t size, bool pad = true)
+{
+    return pad ? (size + 2u) / 3u * 4u : size / 3u * 4u + (size % 3u ? size % 3u + 1u : 0u);
+}
+
+/**
+ * Number of bytes `text` decodes to, if valid.
+ */
+constexpr std::size_t base64_decoded_size(std::string_view text)
+{
+    auto size = text.size();
+    if (size > 0u && text[size - 1u] == '=')
+        size -= (size >= 2u && text[size - 2u] == '=') ? 2u : 1u;
+
+    return size / 4u * 3u + (size % 4u > 1u ? size % 4u - 1u : 0u);
+}
+
+/**
+ * Encode `data` as base64 to output iterator `out`.
+ *
+ * Returns the iterator behind the last written char. Writing to
+ * a `char*` with room for `base64_encoded_size` chars is fastest.
+ */
+template <class _Iter>
+_Iter encode_base64(_Iter out,
+                    std::string_view data,
+                    base64_alphabet alphabet = base64_alphabet::standard,
+                    bool pad = true)
+{
+    const auto* in = reinterpret_cast<const std::uint8_t*>(data.data());
+
+    if constexpr (std::is_same_v<_Iter, char*>) {
+        return base64_impl::encode(in, data.size(), out, alphabet, pad);
+    } else {
+        /* Encode chunks of 768 bytes (a multiple of 3) on the stack. */
+        char buffer[1024];
+        auto size = data.size();
+        while (size > 768u) {
+            out = std::copy(buffer, base64_impl::encode(in, 768u, buffer, alphabet, pad), out);
+            in += 768u;
+            size -= 768u;
+        }
+        return std::copy(buffer, base64_impl::encode(in, size, buffer, alphabet, pad), out);
+    }
+}
+
+/**
+ * Decode base64 `text` to output iterator `out`.
+ *
+ * Padding is optional. Returns the iterator behind the last written
+ * byte, or nullopt if `text` is not valid base64 of the given alphabet
+ * (in which case some bytes may have been written).
+ */
+template <class _Iter>
+std::optional<_Iter> decode_base64(_Iter out,
+                                   std::string_view text,
+                                   base64_alphabet alphabet = base64_alphabet::standard)
+{
+    if constexpr (std::is_same_v<_Iter, char*> || std::is_same_v<_Iter, std::uint8_t*>) {
+        auto* end = base64_impl::decode(text.data(), text.size(), reinterpret_cast<std::uint8_t*>(out), alphabet, true);
+        if (!end)
+            return {};
+        return reinterpret_cast<_Iter>(end);
+    } else {
+        /* Decode chunks of 1024 chars (a multiple of 4) on the stack. */
+        std::uint8_t buffer[768];
+        while (!text.empty()) {
+            const auto chunk = std::min<std::size_t>(text.size(), 1024u);
+            auto* end = base64_impl::decode(text.data(), chunk, buffer, alphabet, chunk == text.size());
+            if (!end)
+                return {};
+
+            out = std::copy(buffer, end, out);
+            text.remove_prefix(chunk);
+        }
+        return out;
+    }
+}
+
+/**
+ * Encode `data` as base64.
+ *
+ * The result type can be changed using `_String`, e.g.
+ * `to_base64<std::pmr::string>(data, base64_alphabet::url, false, &arena)`.
+ */
+template <class _String = std::string>
+_String to_base64(std::string_view data,
+                  base64_alphabet alphabet = base64_alphabet::standard,
+                  bool pad = true,
+                  const typename _String::allocator_type& alloc = {})
+{
+    _String str(alloc);
+    str.resize(base64_encoded_size(data.size(), pad));
+    encode_base64(&str[0], data, alphabet, pad);
+    return str;
+}
+
+/**
+ * Decode base64 `text`.
+ *
+ * Returns nullopt if `text` is not valid base64 of the given alphabet.
+ */
+template <class _String = std::string>
+std::optional<_String> from_base64(std::string_view text,
+                                   base64_alphabet alphabet = base64_alphabet::standard,
+                                   const typename _String::allocator_type& alloc = {})
+{
+    _String str(alloc);
+    str.resize(base64_decoded_size(text));
+    if (!decode_base64(&str[0], text, alphabet))
+        return {};
+    return str;
+}
+
+}
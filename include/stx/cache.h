@@ -0,0 +1,662 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stx
+{
+
+/**
+ * Default entry weight of caches limited in bytes: `sizeof` of key and
+ * value, plus the content of string-like and container types (anything
+ * with `data()` and `size()`).
+ */
+struct cache_weight
+{
+    template <class _Key, class _Value>
+    std::size_t operator()(const _Key& key, const _Value& value) const
+    {
+        return of(key) + of(value);
+    }
+
+private:
+    template <class _T, class = void>
+    struct has_data : std::false_type {};
+
+    template <class _T>
+    struct has_data<_T, std::void_t<decltype(std::declval<const _T&>().data()),
+                                    decltype(std::declval<const _T&>().size())>> : std::true_type {};
+
+    template <class _T>
+    static std::size_t of(const _T& v)
+    {
+        if constexpr (has_data<_T>::value) {
+            return sizeof(_T) + v.size() * sizeof(*v.data());
+        } else {
+            return sizeof(_T);
+        }
+    }
+};
+
+/**
+ * Cache statistics.
+ */
+struct cache_stats
+{
+    std::size_t hits = 0u;
+    std::size_t misses = 0u;
+    std::size_t evictions = 0u;
+};
+
+namespace cache_impl
+{
+
+constexpr std::uint32_t none = ~std::uint32_t(0u);
+
+/**
+ * Least recently used: entries form a doubly linked list (by index),
+ * hits move the entry to the front.
+ */
+struct lru
+{
+    struct link
+    {
+        std::uint32_t prev = none;
+        std::uint32_t next = none;
+    };
+
+    template <class _Nodes>
+    void insert(_Nodes& nodes, std::uint32_t n)
+    {
+        nodes[n].link = {none, head};
+        if (head != none)
+            nodes[head].link.prev = n;
+        head = n;
+        if (tail == none)
+            tail = n;
+    }
+
+    template <class _Nodes>
+    void erase(_Nodes& nodes, std::uint32_t n)
+    {
+        const auto [prev, next] = nodes[n].link;
+        (prev != none ? nodes[prev].link.next : head) = next;
+        (next != none ? nodes[next].link.prev : tail) = prev;
+    }
+
+    template <class _Nodes>
+    void touch(_Nodes& nodes, std::uint32_t n)
+    {
+        if (n != head) {
+            erase(nodes, n);
+            insert(nodes, n);
+        }
+    }
+
+    template <class _Nodes>
+    std::uint32_t victim(_Nodes&)
+    {
+        return tail;
+    }
+
+    void clear()
+    {
+        head = tail = none;
+    }
+
+    std::uint32_t head = none;
+    std::uint32_t tail = none;
+};
+
+/**
+ * CLOCK (second chance): hits only set a flag, a hand sweeping over all
+ * entries evicts the first one not referenced since the last sweep.
+ */
+struct clock
+{
+    struct link
+    {
+        bool referenced = false;
+    };
+
+    template <class _Nodes>
+    void insert(_Nodes& nodes, std::uint32_t n)
+    {
+        nodes[n].link.referenced = true;
+    }
+
+    template <class _Nodes>
+    void erase(_Nodes&, std::uint32_t)
+    {}
+
+    template <class _Nodes>
+    void touch(_Nodes& nodes, std::uint32_t n)
+    {
+        nodes[n].link.referenced = true;
+    }
+
+    template <class _Nodes>
+    std::uint32_t victim(_Nodes& nodes)
+    {
+        for (;;) {
+            const auto n = hand;
+            hand = (hand + 1u) % static_cast<std::uint32_t>(nodes.size());
+
+            auto& node = nodes[n];
+            if (!node.used)
+                continue;
+            if (!node.link.referenced)
+                return n;
+            node.link.referenced = false;
+        }
+    }
+
+    void clear()
+    {
+        hand = 0u;
+    }
+
+    std::uint32_t hand = 0u;
+};
+
+/* Murmur3 finalizer */
+inline std::uint64_t mix(std::uint64_t h)
+{
+    h ^= h >> 33u;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33u;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33u;
+    return h;
+}
+
+}
+
+/**
+ * Bounded cache with pluggable eviction policy. Use `lru_cache` or
+ * `clock_cache`.
+ *
+ * Entries are stored in a single vector and linked by index, the key
+ * index is an open addressing hash table; inserting does not allocate
+ * per entry. The cache is limited to `max_entries` entries and/or to
+ * `max_bytes` bytes as measured by `_Weigh` (an entry larger than
+ * `max_bytes` is stored alone); 0 means no limit. The index grows
+ * with the number of entries, not with the limits.
+ *
+ * Pointers and references to values are invalidated by the next
+ * modification of the cache.
+ *
+ * Not thread-safe, see `sharded_cache`.
+ */
+template <class _Key,
+          class _Value,
+          class _Policy,
+          class _Hash = std::hash<_Key>,
+          class _Equal = std::equal_to<_Key>,
+          class _Weigh = cache_weight>
+class basic_cache
+{
+public:
+    using key_type = _Key;
+    using mapped_type = _Value;
+    using hasher = _Hash;
+
+    explicit basic_cache(std::size_t max_entries, std::size_t max_bytes = 0u)
+        : max_entries_(max_entries > 0u ? std::min<std::size_t>(max_entries, cache_impl::none - 1u)
+                                        : cache_impl::none - 1u)
+        , max_bytes_(max_bytes)
+        , index_(std::size_t(1u) << index_bits_, 0u)
+    {}
+
+    /**
+     * Returns a pointer to the value of `key` and marks it as used,
+     * or nullptr. Counts a hit or miss.
+     */
+    const _Value* find(const _Key& key)
+    {
+        const auto n = lookup(key, _Hash()(key));
+        if (n == cache_impl::none) {
+            ++stats_.misses;
+            return nullptr;
+        }
+
+        ++stats_.hits;
+        policy_.touch(nodes_, n);
+        return &nodes_[n].value;
+    }
+
+    /**
+     * Returns true if `key` is cached. Does not count as use.
+     */
+    bool contains(const _Key& key) const
+    {
+        return lookup(key, _Hash()(key)) != cache_impl::none;
+    }
+
+    /**
+     * Returns the value of `key`, or fallback value `v` if not cached.
+     * See `stx::value_or`; a reference is only returned for lvalue
+     * fallbacks of type `_Value`.
+     */
+    template <class _FallbackType>
+    auto value_or(const _Key& key, _FallbackType&& v)
+        -> std::conditional_t<std::is_lvalue_reference_v<_FallbackType> &&
+                              std::is_same_v<std::decay_t<_FallbackType>, _Value>, const _Value&, _Value>
+    {
+        if (const auto* value = find(key))
+            return *value;
+        return std::forward<_FallbackType>(v);
+    }
+
+    /**
+     * Returns the value of `key`. If not cached, `fn(key)` is called and
+     * its result inserted.
+     */
+    template <class _Fn>
+    const _Value& get_or_compute(const _Key& key, _Fn&& fn)
+    {
+        if (const auto* value = find(key))
+            return *value;
+        return insert_or_assign(key, fn(key));
+    }
+
+    /**
+     * Insert or replace the value of `key`, evicting entries if needed.
+     */
+    template <class _V>
+    const _Value& insert_or_assign(const _Key& key, _V&& value)
+    {
+        const auto hash = _Hash()(key);
+        auto n = lookup(key, hash);
+
+        if (n != cache_impl::none) {
+            nodes_[n].value = std::forward<_V>(value);
+            policy_.touch(nodes_, n);
+        } else {
+            /* `value` may refer to an entry evicted below. */
+            _Value local(std::forward<_V>(value));
+
+            while (size_ >= max_entries_) {
+                remove(policy_.victim(nodes_));
+                ++stats_.evictions;
+            }
+
+            if (!free_.empty()) {
+                n = free_.back();
+                free_.pop_back();
+
+                auto& node = nodes_[n];
+                node.key = key;
+                node.value = std::move(local);
+                node.hash = hash;
+                node.weight = 0u;
+                node.used = true;
+            } else {
+                n = static_cast<std::uint32_t>(nodes_.size());
+                nodes_.push_back({key, std::move(local), hash, 0u, true, {}});
+            }
+
+            /* Keep the index at most half full. */
+            if (2u * (size_ + 1u) > index_.size())
+                grow_index();
+            insert_index(n, hash);
+
+            policy_.insert(nodes_, n);
+            ++size_;
+        }
+
+        if (max_bytes_ > 0u) {
+            auto& node = nodes_[n];
+            const auto weight = _Weigh()(node.key, node.value);
+            bytes_ = bytes_ - node.weight + weight;
+            node.weight = weight;
+
+            while (bytes_ > max_bytes_ && size_ > 1u) {
+                const auto victim = policy_.victim(nodes_);
+                if (victim != n) {
+                    remove(victim);
+                    ++stats_.evictions;
+                }
+            }
+        }
+
+        return nodes_[n].value;
+    }
+
+    /**
+     * Remove `key`. Returns true if removed.
+     */
+    bool erase(const _Key& key)
+    {
+        const auto n = lookup(key, _Hash()(key));
+        if (n == cache_impl::none)
+            return false;
+
+        remove(n);
+        return true;
+    }
+
+    /**
+     * Remove all entries. Does not reset the statistics.
+     */
+    void clear()
+    {
+        nodes_.clear();
+        free_.clear();
+        std::fill(index_.begin(), index_.end(), 0u);
+        policy_.clear();
+        size_ = 0u;
+        bytes_ = 0u;
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /**
+     * Weight of all entries, if limited in bytes (0 otherwise).
+     */
+    std::size_t bytes() const
+    {
+        return bytes_;
+    }
+
+    std::size_t max_entries() const
+    {
+        return max_entries_;
+    }
+
+    std::size_t max_bytes() const
+    {
+        return max_bytes_;
+    }
+
+    const cache_stats& stats() const
+    {
+        return stats_;
+    }
+
+    void reset_stats()
+    {
+        stats_ = {};
+    }
+
+private:
+    struct node
+    {
+        _Key key;
+        _Value value;
+        std::size_t hash;
+        std::size_t weight;
+        bool used;
+        typename _Policy::link link;
+    };
+
+    std::size_t index_mask() const
+    {
+        return index_.size() - 1u;
+    }
+
+    std::size_t home(std::size_t hash) const
+    {
+        /* Fibonacci hashing: std::hash is the identity for integers. */
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ull) >> (64u - index_bits_));
+    }
+
+    void insert_index(std::uint32_t n, std::size_t hash)
+    {
+        auto slot = home(hash);
+        while (index_[slot] != 0u)
+            slot = (slot + 1u) & index_mask();
+        index_[slot] = n + 1u;
+    }
+
+    void grow_index()
+    {
+        ++index_bits_;
+        index_.assign(std::size_t(1u) << index_bits_, 0u);
+        for (std::size_t n = 0u; n < nodes_.size(); ++n) {
+            if (nodes_[n].used)
+                insert_index(static_cast<std::uint32_t>(n), nodes_[n].hash);
+        }
+    }
+
+    std::uint32_t lookup(const _Key& key, std::size_t hash) const
+    {
+        for (auto slot = home(hash);; slot = (slot + 1u) & index_mask()) {
+            const auto entry = index_[slot];
+            if (entry == 0u)
+                return cache_impl::none;
+
+            const auto& node = nodes_[entry - 1u];
+            if (node.hash == hash && _Equal()(node.key, key))
+                return entry - 1u;
+        }
+    }
+
+    void remove(std::uint32_t n)
+    {
+        auto& node = nodes_[n];
+
+        /* Backward shift deletion */
+        auto slot = home(node.hash);
+        while (index_[slot] != n + 1u)
+            slot = (slot + 1u) & index_mask();
+
+        for (auto next = (slot + 1u) & index_mask(); index_[next] != 0u; next = (next + 1u) & index_mask()) {
+            const auto ideal = home(nodes_[index_[next] - 1u].hash);
+            if (((next - ideal) & index_mask()) >= ((next - slot) & index_mask())) {
+                index_[slot] = index_[next];
+                slot = next;
+            }
+        }
+        index_[slot] = 0u;
+
+        policy_.erase(nodes_, n);
+        node.used = false;
+        if constexpr (std::is_default_constructible_v<_Value>)
+            node.value = _Value(); /* Release memory held by the value */
+
+        free_.push_back(n);
+        --size_;
+        bytes_ -= node.weight;
+    }
+
+    std::size_t max_entries_;
+    std::size_t max_bytes_;
+    unsigned index_bits_ = 4u;
+
+    std::vector<node> nodes_;
+    std::vector<std::uint32_t> free_;
+    std::vector<std::uint32_t> index_; /* Node index + 1 */
+    _Policy policy_;
+
+    std::size_t size_ = 0u;
+    std::size_t bytes_ = 0u;
+    cache_stats stats_;
+};
+
+/**
+ * Least recently used cache.
+ *
+ * Example:
+ *   stx::lru_cache<int, std::string> cache(1000);
+ *   const auto& text = cache.get_or_compute(id, [](int id) {
+ *       return stx::format("#{}", id);
+ *   });
+ */
+template <class _Key,
+          class _Value,
+          class _Hash = std::hash<_Key>,
+          class _Equal = std::equal_to<_Key>,
+          class _Weigh = cache_weight>
+using lru_cache = basic_cache<_Key, _Value, cache_impl::lru, _Hash, _Equal, _Weigh>;
+
+/**
+ * CLOCK cache: approximates LRU, but a hit only sets a flag instead of
+ * relinking the entry.
+ */
+template <class _Key,
+          class _Value,
+          class _Hash = std::hash<_Key>,
+          class _Equal = std::equal_to<_Key>,
+          class _Weigh = cache_weight>
+using clock_cache = basic_cache<_Key, _Value, cache_impl::clock, _Hash, _Equal, _Weigh>;
+
+/**
+ * Thread-safe cache, distributing keys over independently locked
+ * shards of type `_Cache` (e.g. `sharded_cache<lru_cache<K, V>>`).
+ * The limits are split evenly across the shards.
+ *
+ * Values are returned by copy.
+ */
+template <class _Cache>
+class sharded_cache
+{
+public:
+    using key_type = typename _Cache::key_type;
+    using mapped_type = typename _Cache::mapped_type;
+
+    explicit sharded_cache(std::size_t max_entries, std::size_t max_bytes = 0u, std::size_t shards = 16u)
+    {
+        while ((std::size_t(1u) << shard_bits_) < shards && shard_bits_ < 16u)
+            ++shard_bits_;
+
+        const auto count = std::size_t(1u) << shard_bits_;
+        shards_.reserve(count);
+        for (std::size_t i = 0u; i < count; ++i)
+            shards_.push_back(std::make_unique<shard>(split(max_entries, count), split(max_bytes, count)));
+    }
+
+    template <class _FallbackType>
+    mapped_type value_or(const key_type& key, _FallbackType&& v)
+    {
+        auto& sh = shard_of(key);
+        std::lock_guard lock(sh.mutex);
+        return sh.cache.value_or(key, std::forward<_FallbackType>(v));
+    }
+
+    /**
+     * Returns the value of `key`. If not cached, `fn(key)` is called
+     * without holding a lock (so concurrent misses of the same key may
+     * call it more than once).
+     */
+    template <class _Fn>
+    mapped_type get_or_compute(const key_type& key, _Fn&& fn)
+    {
+        auto& sh = shard_of(key);
+        {
+            std::lock_guard lock(sh.mutex);
+            if (const auto* value = sh.cache.find(key))
+                return *value;
+        }
+
+        mapped_type value = fn(key);
+
+        std::lock_guard lock(sh.mutex);
+        sh.cache.insert_or_assign(key, value);
+        return value;
+    }
+
+    template <class _V>
+    void insert_or_assign(const key_type& key, _V&& value)
+    {
+        auto& sh = shard_of(key);
+        std::lock_guard lock(sh.mutex);
+        sh.cache.insert_or_assign(key, std::forward<_V>(value));
+    }
+
+    bool erase(const key_type& key)
+    {
+        auto& sh = shard_of(key);
+        std::lock_guard lock(sh.mutex);
+        return sh.cache.erase(key);
+    }
+
+    bool contains(const key_type& key) const
+    {
+        const auto& sh = shard_of(key);
+        std::lock_guard lock(sh.mutex);
+        return sh.cache.contains(key);
+    }
+
+    void clear()
+    {
+        for (auto& sh : shards_) {
+            std::lock_guard lock(sh->mutex);
+            sh->cache.clear();
+        }
+    }
+
+    std::size_t size() const
+    {
+        std::size_t n = 0u;
+        for (const auto& sh : shards_) {
+            std::lock_guard lock(sh->mutex);
+            n += sh->cache.size();
+        }
+        return n;
+    }
+
+    /**
+     * Sum of the statistics of all shards.
+     */
+    cache_stats stats() const
+    {
+        cache_stats total;
+        for (const auto& sh : shards_) {
+            std::lock_guard lock(sh->mutex);
+            total.hits += sh->cache.stats().hits;
+            total.misses += sh->cache.stats().misses;
+            total.evictions += sh->cache.stats().evictions;
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) shard
+    {
+        shard(std::size_t max_entries, std::size_t max_bytes)
+            : cache(max_entries, max_bytes)
+        {}
+
+        mutable std::mutex mutex;
+        _Cache cache;
+    };
+
+    /* Round up, keeping 0 (no limit) and without overflow. */
+    static std::size_t split(std::size_t limit, std::size_t count)
+    {
+        return limit / count + (limit % count != 0u);
+    }
+
+    shard& shard_of(const key_type& key)
+    {
+        return *shards_[shard_index(key)];
+    }
+
+    const shard& shard_of(const key_type& key) const
+    {
+        return *shards_[shard_index(key)];
+    }
+
+    std::size_t shard_index(const key_type& key) const
+    {
+        /* Different bits than the index of the shard's cache. */
+        const auto h = cache_impl::mix(static_cast<std::uint64_t>(typename _Cache::hasher()(key)));
+        return static_cast<std::size_t>(h) & ((std::size_t(1u) << shard_bits_) - 1u);
+    }
+
+    unsigned shard_bits_ = 0u;
+    std::vector<std::unique_ptr<shard>> shards_;
+};
+
+}
@@ -0,0 +1,550 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "format.h"
+
+namespace stx
+{
+
+/**
+ * Argument type tags, stored per argument in captured records.
+ */
+enum class capture_tag : std::uint8_t
+{
+    boolean,
+    character,
+    i8, u8, i16, u16, i32, u32, i64, u64,
+    f32, f64,
+    byte,
+    string, /* 32 bit size + bytes */
+};
+
+/**
+ * Stable id of format string `fmt` (64 bit FNV-1a hash), stored in
+ * captured records instead of the format string.
+ */
+constexpr std::uint64_t capture_format_id(std::string_view fmt)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const auto c : fmt) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Format string with its `capture_format_id`. Declare it `constexpr`
+ * to hash the format string at compile time instead of on every
+ * `capture_to`.
+ *
+ * Example:
+ *   static constexpr capture_format fmt("{}: {}");
+ *   capture_to(records, fmt, "id", 42);
+ *
+ * The format string is not copied and must outlive all captures.
+ */
+class capture_format
+{
+public:
+    explicit constexpr capture_format(std::string_view fmt)
+        : fmt_(fmt)
+        , id_(capture_format_id(fmt))
+    {}
+
+    constexpr std::string_view str() const
+    {
+        return fmt_;
+    }
+
+    constexpr std::uint64_t id() const
+    {
+        return id_;
+    }
+
+private:
+    std::string_view fmt_;
+    std::uint64_t id_;
+};
+
+/**
+ * Dictionary of format strings by `capture_format_id`, needed to
+ * decode captured records.
+ *
+ * `capture_to` registers all format strings in `global()`. To decode
+ * records in another process, save the dictionary using `write_to`
+ * and load it there using `read_from`.
+ *
+ * Thread safe.
+ */
+class capture_formats
+{
+public:
+    capture_formats() = default;
+
+    capture_formats(const capture_formats&) = delete;
+    capture_formats& operator=(const capture_formats&) = delete;
+
+    /**
+     * Dictionary used by `capture_to`.
+     */
+    static capture_formats& global()
+    {
+        static capture_formats formats;
+        return formats;
+    }
+
+    /**
+     * Add format string `fmt`, returns its id.
+     *
+     * Throws std::invalid_argument if a different format string with
+     * the same id was added before.
+     */
+    std::uint64_t add(std::string_view fmt)
+    {
+        const auto id = capture_format_id(fmt);
+        add(id, fmt);
+        return id;
+    }
+
+    /**
+     * Returns the format string of `id`, if known.
+     */
+    std::optional<std::string_view> find(std::uint64_t id) const
+    {
+        std::shared_lock lock(mutex_);
+        if (auto iter = formats_.find(id); iter != formats_.end())
+            return std::string_view(iter->second);
+        return {};
+    }
+
+    std::size_t size() const
+    {
+        std::shared_lock lock(mutex_);
+        return formats_.size();
+    }
+
+    /**
+     * Append all format strings to char container `out`.
+     */
+    template <class _Container>
+    void write_to(_Container& out) const
+    {
+        std::shared_lock lock(mutex_);
+        for (const auto& [id, fmt] : formats_) {
+            const auto size = static_cast<std::uint32_t>(fmt.size());
+            const auto offset = out.size();
+            out.resize(offset + sizeof(id) + sizeof(size) + size);
+
+            auto* ptr = reinterpret_cast<char*>(out.data()) + offset;
+            std::memcpy(ptr, &id, sizeof(id));
+            std::memcpy(ptr + sizeof(id), &size, sizeof(size));
+            std::memcpy(ptr + sizeof(id) + sizeof(size), fmt.data(), size);
+        }
+    }
+
+    /**
+     * Add all format strings written by `write_to`.
+     * Returns false if `data` is truncated.
+     */
+    bool read_from(std::string_view data)
+    {
+        std::uint64_t id;
+        std::uint32_t size;
+        while (data.size() >= sizeof(id) + sizeof(size)) {
+            std::memcpy(&id, data.data(), sizeof(id));
+            std::memcpy(&size, data.data() + sizeof(id), sizeof(size));
+            data.remove_prefix(sizeof(id) + sizeof(size));
+            if (data.size() < size)
+                return false;
+
+            add(id, data.substr(0u, size));
+            data.remove_prefix(size);
+        }
+
+        return data.empty();
+    }
+
+private:
+    void add(std::uint64_t id, std::string_view fmt)
+    {
+        std::unique_lock lock(mutex_);
+        const auto [iter, inserted] = formats_.emplace(id, fmt);
+        if (!inserted && iter->second != fmt)
+            throw std::invalid_argument("stx::capture_formats: format id collision");
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::uint64_t, std::string> formats_;
+};
+
+namespace capture_impl
+{
+
+/**
+ * Record header, followed by one `capture_tag` per argument and the
+ * argument bytes.
+ */
+struct header
+{
+    std::uint32_t size; /* Total record size, including the header. */
+    std::uint32_t arg_count;
+    std::uint64_t format_id;
+};
+
+template <class _Type>
+inline constexpr bool is_string_v = format_impl::is_string_like_v<_Type>;
+
+template <class _Type>
+constexpr capture_tag tag_of()
+{
+    if constexpr (is_string_v<_Type>) {
+        return capture_tag::string;
+    } else if constexpr (std::is_same_v<_Type, bool>) {
+        return capture_tag::boolean;
+    } else if constexpr (std::is_same_v<_Type, char>) {
+        return capture_tag::character;
+    } else if constexpr (std::is_same_v<_Type, std::byte>) {
+        return capture_tag::byte;
+    } else if constexpr (std::is_same_v<_Type, float>) {
+        return capture_tag::f32;
+    } else if constexpr (std::is_same_v<_Type, double>) {
+        return capture_tag::f64;
+    } else if constexpr (std::is_floating_point_v<_Type>) {
+        static_assert(!std::is_same_v<_Type, long double>,
+                      "stx::capture does not support long double, cast to double");
+        return capture_tag::f64;
+    } else {
+        static_assert(std::is_integral_v<_Type>,
+                      "stx::capture supports strings, arithmetic values and std::byte only");
+
+        constexpr auto is_signed = std::is_signed_v<_Type>;
+        switch (sizeof(_Type)) {
+        case 1u: return is_signed ? capture_tag::i8 : capture_tag::u8;
+        case 2u: return is_signed ? capture_tag::i16 : capture_tag::u16;
+        case 4u: return is_signed ? capture_tag::i32 : capture_tag::u32;
+        default: return is_signed ? capture_tag::i64 : capture_tag::u64;
+        }
+    }
+}
+
+/**
+ * String view of string-like `value`, null C strings are empty.
+ */
+template <class _Type>
+std::string_view to_string_view(const _Type& value)
+{
+    if constexpr (std::is_pointer_v<_Type>) {
+        return value ? std::string_view(value) : std::string_view();
+    } else {
+        return std::string_view(value);
+    }
+}
+
+template <class _Type>
+std::size_t encoded_size(const _Type& value)
+{
+    if constexpr (is_string_v<_Type>) {
+        return sizeof(std::uint32_t) + to_string_view(value).size();
+    } else {
+        (void)value;
+        return sizeof(_Type);
+    }
+}
+
+template <class _Type>
+char* encode(char* out, const _Type& value)
+{
+    if constexpr (is_string_v<_Type>) {
+        const auto str = to_string_view(value);
+        const auto size = static_cast<std::uint32_t>(str.size());
+        std::memcpy(out, &size, sizeof(size));
+        std::memcpy(out + sizeof(size), str.data(), str.size());
+        return out + sizeof(size) + str.size();
+    } else {
+        std::memcpy(out, &value, sizeof(_Type));
+        return out + sizeof(_Type);
+    }
+}
+
+/**
+ * Returns the size of the argument of type `tag` at `[begin, end)`,
+ * or 0 if it exceeds the range.
+ */
+inline std::size_t arg_size(capture_tag tag, const char* begin, const char* end)
+{
+    std::size_t size = 0u;
+    switch (tag) {
+    case capture_tag::boolean:
+    case capture_tag::character:
+    case capture_tag::i8:
+    case capture_tag::u8:
+    case capture_tag::byte: size = 1u; break;
+    case capture_tag::i16:
+    case capture_tag::u16: size = 2u; break;
+    case capture_tag::i32:
+    case capture_tag::u32:
+    case capture_tag::f32: size = 4u; break;
+    case capture_tag::i64:
+    case capture_tag::u64:
+    case capture_tag::f64: size = 8u; break;
+    case capture_tag::string: {
+        std::uint32_t string_size = 0u;
+        if (end - begin < static_cast<std::ptrdiff_t>(sizeof(string_size)))
+            return 0u;
+        std::memcpy(&string_size, begin, sizeof(string_size));
+        size = sizeof(string_size) + string_size;
+        break;
+    }
+    }
+
+    return size <= static_cast<std::size_t>(end - begin) ? size : 0u;
+}
+
+template <class _Type, class _Iter>
+_Iter format_value(const char* data, std::string_view spec, _Iter out)
+{
+    if constexpr (std::is_same_v<_Type, std::string_view>) {
+        std::uint32_t size;
+        std::memcpy(&size, data, sizeof(size));
+        formatter<std::string_view> f(spec);
+        return format_impl::invoke_format(f, std::string_view(data + sizeof(size), size), out);
+    } else {
+        _Type value;
+        std::memcpy(&value, data, sizeof(_Type));
+        formatter<_Type> f(spec);
+        return format_impl::invoke_format(f, value, out);
+    }
+}
+
+template <class _Iter>
+_Iter format_arg(capture_tag tag, const char* data, std::string_view spec, _Iter out)
+{
+    switch (tag) {
+    case capture_tag::boolean: return format_value<bool>(data, spec, out);
+    case capture_tag::character: return format_value<char>(data, spec, out);
+    case capture_tag::i8: return format_value<std::int8_t>(data, spec, out);
+    case capture_tag::u8: return format_value<std::uint8_t>(data, spec, out);
+    case capture_tag::i16: return format_value<std::int16_t>(data, spec, out);
+    case capture_tag::u16: return format_value<std::uint16_t>(data, spec, out);
+    case capture_tag::i32: return format_value<std::int32_t>(data, spec, out);
+    case capture_tag::u32: return format_value<std::uint32_t>(data, spec, out);
+    case capture_tag::i64: return format_value<std::int64_t>(data, spec, out);
+    case capture_tag::u64: return format_value<std::uint64_t>(data, spec, out);
+    case capture_tag::f32: return format_value<float>(data, spec, out);
+    case capture_tag::f64: return format_value<double>(data, spec, out);
+    case capture_tag::byte: return format_value<std::byte>(data, spec, out);
+    case capture_tag::string: return format_value<std::string_view>(data, spec, out);
+    }
+
+    return out;
+}
+
+/**
+ * Render a single record, `args` points behind the header.
+ * Arguments out of range (or exceeding the record) write nothing.
+ */
+template <class _Iter>
+_Iter format_record(_Iter out, std::string_view fmt, const header& h, const char* args, const char* end)
+{
+    const auto* tags = reinterpret_cast<const std::uint8_t*>(args);
+    const char* values = args + h.arg_count;
+
+    format_impl::parse_format(fmt,
+        [&out](std::string_view text) {
+            out = format_impl::write(out, text.data(), text.size());
+        },
+        [&](std::size_t index, std::string_view spec) {
+            if (index >= h.arg_count)
+                return;
+
+            const char* value = values;
+            for (std::size_t i = 0u; i < index; ++i) {
+                const auto size = arg_size(static_cast<capture_tag>(tags[i]), value, end);
+                if (size == 0u)
+                    return;
+                value += size;
+            }
+
+            const auto tag = static_cast<capture_tag>(tags[index]);
+            if (arg_size(tag, value, end) > 0u)
+                out = format_arg(tag, value, spec, out);
+        });
+
+    return out;
+}
+
+/**
+ * Register `fmt` in the global dictionary, once per thread and id.
+ */
+inline std::uint64_t register_format(const capture_format& fmt)
+{
+    const auto id = fmt.id();
+
+    thread_local std::uint64_t known[64] = {};
+    auto& slot = known[id % 64u];
+    if (slot != id) {
+        capture_formats::global().add(fmt.str());
+        slot = id;
+    }
+
+    return id;
+}
+
+inline header read_header(std::string_view record)
+{
+    header h;
+    std::memcpy(&h, record.data(), sizeof(h));
+    return h;
+}
+
+}
+
+/**
+ * Serialize format string and arguments into a binary record, appended
+ * to `records`. The record can be rendered later, on another thread or
+ * in another process, using `format_captured_to`.
+ *
+ * Records store the id of the format string (see `capture_formats`),
+ * a type tag per argument and the argument bytes. Strings are copied
+ * (null C strings as empty strings), other arguments must be arithmetic
+ * values (except long double) or std::byte.
+ *
+ * Passing a `constexpr capture_format` instead of a string view skips
+ * hashing the format string.
+ *
+ * Records use the byte order of the capturing machine. Only the first
+ * capture of a format string allocates (to register it), besides
+ * growing `records`.
+ *
+ * Example:
+ *   std::string records;
+ *   capture_to(records, "{}: {:.>5}", "id", 42);
+ *   ...
+ *   format_captured(records) => "id: ...42"
+ *
+ * @param records  Container of chars (std::string, std::vector<char>, ...).
+ */
+template <class _Container, class... _Args>
+void capture_to(_Container& records, const capture_format& fmt, const _Args& ...args)
+{
+    constexpr capture_tag tags[sizeof...(_Args) + 1u] = {capture_impl::tag_of<_Args>()...};
+
+    const auto size = sizeof(capture_impl::header) + sizeof...(_Args) +
+                      (std::size_t(0u) + ... + capture_impl::encoded_size(args));
+    const capture_impl::header h{
+        static_cast<std::uint32_t>(size),
+        static_cast<std::uint32_t>(sizeof...(_Args)),
+        capture_impl::register_format(fmt)
+    };
+
+    const auto offset = records.size();
+    records.resize(offset + size);
+
+    auto* out = reinterpret_cast<char*>(records.data()) + offset;
+    std::memcpy(out, &h, sizeof(h));
+    out += sizeof(h);
+    std::memcpy(out, tags, sizeof...(_Args));
+    out += sizeof...(_Args);
+    ((out = capture_impl::encode(out, args)), ...);
+}
+
+/**
+ * See `capture_to`.
+ */
+template <class _Container, class... _Args>
+void capture_to(_Container& records, std::string_view fmt, const _Args& ...args)
+{
+    capture_to(records, capture_format(fmt), args...);
+}
+
+/**
+ * See `capture_to`.
+ *
+ * Returns a single record.
+ */
+template <class... _Args>
+std::string capture(std::string_view fmt, const _Args& ...args)
+{
+    std::string record;
+    capture_to(record, fmt, args...);
+    return record;
+}
+
+/**
+ * See `capture_to`.
+ *
+ * Returns a single record.
+ */
+template <class... _Args>
+std::string capture(const capture_format& fmt, const _Args& ...args)
+{
+    std::string record;
+    capture_to(record, fmt, args...);
+    return record;
+}
+
+/**
+ * Returns the size of the first record in `records`, or 0 if
+ * `records` does not start with a complete record.
+ */
+inline std::size_t captured_size(std::string_view records)
+{
+    if (records.size() < sizeof(capture_impl::header))
+        return 0u;
+
+    const auto h = capture_impl::read_header(records);
+    if (h.size < sizeof(capture_impl::header) + h.arg_count)
+        return 0u;
+
+    return h.size <= records.size() ? h.size : 0u;
+}
+
+/**
+ * Render all records in `records` to `out`, as `format_to` would
+ * have when capturing them. Format strings are looked up in `formats`;
+ * records with unknown format ids write nothing.
+ *
+ * Returns the iterator behind the last written character.
+ */
+template <class _Iter>
+_Iter format_captured_to(_Iter out, std::string_view records,
+                         const capture_formats& formats = capture_formats::global())
+{
+    while (const auto size = captured_size(records)) {
+        const auto h = capture_impl::read_header(records);
+        if (const auto fmt = formats.find(h.format_id))
+            out = capture_impl::format_record(out, *fmt, h,
+                                              records.data() + sizeof(capture_impl::header),
+                                              records.data() + size);
+
+        records.remove_prefix(size);
+    }
+
+    return out;
+}
+
+/**
+ * See `format_captured_to`.
+ */
+template <class _String = std::string>
+_String format_captured(std::string_view records,
+                        const capture_formats& formats = capture_formats::global())
+{
+    _String out;
+    format_captured_to(std::back_inserter(out), records, formats);
+    return out;
+}
+
+}
@@ -0,0 +1,475 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ratio>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+
+#include "formatter.h"
+#include "format_impl.h"
+
+namespace stx::chrono_impl
+{
+
+struct civil_time
+{
+    std::int64_t year;
+    unsigned month;   /* 1-12 */
+    unsigned day;     /* 1-31 */
+    unsigned weekday; /* 0-6, 0 = Sunday */
+    unsigned hour;
+    unsigned minute;
+    unsigned second;
+};
+
+/**
+ * Convert seconds since 1970-01-01 00:00:00 UTC to a civil (proleptic
+ * Gregorian) UTC date and time. No locale or time zone functions involved.
+ *
+ * See http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+ */
+constexpr civil_time civil_from_seconds(std::int64_t seconds)
+{
+    auto days = seconds / 86400;
+    auto secs = seconds % 86400;
+    if (secs < 0) {
+        secs += 86400;
+        --days;
+    }
+
+    civil_time t{};
+    t.hour = static_cast<unsigned>(secs / 3600);
+    t.minute = static_cast<unsigned>(secs / 60 % 60);
+    t.second = static_cast<unsigned>(secs % 60);
+    t.weekday = static_cast<unsigned>(((days + 4) % 7 + 7) % 7); /* 1970-01-01 was a Thursday. */
+
+    const auto z = days + 719468;
+    const auto era = (z >= 0 ? z : z - 146096) / 146097;
+    const auto doe = z - era * 146097;
+    const auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const auto mp = (5 * doy + 2) / 153;
+
+    t.day = static_cast<unsigned>(doy - (153 * mp + 2) / 5 + 1);
+    t.month = static_cast<unsigned>(mp < 10 ? mp + 3 : mp - 9);
+    t.year = yoe + era * 400 + (t.month <= 2);
+    return t;
+}
+
+/**
+ * Number of fractional second digits required for duration `_Duration`.
+ */
+template <class _Duration>
+constexpr unsigned fraction_digits()
+{
+    unsigned digits = 0u;
+    for (std::intmax_t p = 1; p < _Duration::period::den && digits < 9u; p *= 10)
+        ++digits;
+    return digits;
+}
+
+constexpr std::intmax_t pow10(unsigned n)
+{
+    return n == 0u ? 1 : 10 * pow10(n - 1u);
+}
+
+/**
+ * Bounded char buffer writer; output exceeding the buffer is dropped.
+ */
+struct writer
+{
+    char* begin;
+    char* pos;
+    char* end;
+
+    void put(char c)
+    {
+        if (pos != end)
+            *pos++ = c;
+    }
+
+    void put(std::string_view sv)
+    {
+        for (auto c : sv)
+            put(c);
+    }
+
+    /* Write `value` with at least `width` digits. */
+    void put_uint(std::uint64_t value, unsigned width)
+    {
+        char digits[20];
+        unsigned n = 0u;
+        do {
+            digits[n++] = static_cast<char>('0' + value % 10u);
+            value /= 10u;
+        } while (value);
+
+        while (width > n) {
+            put('0');
+            --width;
+        }
+        while (n)
+            put(digits[--n]);
+    }
+
+    void put_int(std::int64_t value, unsigned width)
+    {
+        if (value < 0) {
+            put('-');
+            put_uint(static_cast<std::uint64_t>(-(value + 1)) + 1u, width);
+        } else {
+            put_uint(static_cast<std::uint64_t>(value), width);
+        }
+    }
+
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(pos - begin);
+    }
+};
+
+inline constexpr std::string_view weekday_names[] = {
+    "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+};
+
+inline constexpr std::string_view month_names[] = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December"
+};
+
+/**
+ * Render second-resolution fields of `pattern` for time `t`.
+ *
+ * Fractional fields (%f) are written as `digits` zeros, their offsets
+ * are stored to `fractions` (at most `max_fractions`) for patching.
+ * Returns the number of fraction fields, which is zero for `digits`
+ * zero, as there is nothing to patch then.
+ */
+inline std::size_t render_time(std::string_view pattern, const civil_time& t, unsigned digits,
+                               writer& w, std::size_t* fractions, std::size_t max_fractions)
+{
+    std::size_t fraction_count = 0u;
+
+    for (std::size_t i = 0u; i < pattern.size(); ++i) {
+        if (pattern[i] != '%' || i + 1u == pattern.size()) {
+            w.put(pattern[i]);
+            continue;
+        }
+
+        switch (pattern[++i]) {
+        case 'Y': w.put_int(t.year, 4u); break;
+        case 'y': w.put_uint(static_cast<std::uint64_t>((t.year % 100 + 100) % 100), 2u); break;
+        case 'm': w.put_uint(t.month, 2u); break;
+        case 'd': w.put_uint(t.day, 2u); break;
+        case 'H': w.put_uint(t.hour, 2u); break;
+        case 'M': w.put_uint(t.minute, 2u); break;
+        case 'S': w.put_uint(t.second, 2u); break;
+        case 'F':
+            w.put_int(t.year, 4u); w.put('-'); w.put_uint(t.month, 2u); w.put('-'); w.put_uint(t.day, 2u);
+            break;
+        case 'T':
+            w.put_uint(t.hour, 2u); w.put(':'); w.put_uint(t.minute, 2u); w.put(':'); w.put_uint(t.second, 2u);
+            break;
+        case 'a': w.put(weekday_names[t.weekday].substr(0u, 3u)); break;
+        case 'A': w.put(weekday_names[t.weekday]); break;
+        case 'b': w.put(month_names[t.month - 1u].substr(0u, 3u)); break;
+        case 'B': w.put(month_names[t.month - 1u]); break;
+        case 'z': w.put("+0000"); break;
+        case 'Z': w.put("UTC"); break;
+        case 'f':
+            if (digits && fraction_count < max_fractions)
+                fractions[fraction_count++] = w.size();
+            for (unsigned n = 0u; n < digits; ++n)
+                w.put('0');
+            break;
+        case '%': w.put('%'); break;
+        default:
+            w.put('%');
+            w.put(pattern[i]);
+            break;
+        }
+    }
+
+    return fraction_count;
+}
+
+/**
+ * Per-thread cache of the last rendered time point (at second resolution).
+ *
+ * Timestamps of log lines mostly share the same second, so only
+ * the fractional digits have to be patched in.
+ */
+struct time_cache
+{
+    static constexpr std::size_t max_pattern = 64u;
+    static constexpr std::size_t max_output = 256u;
+    static constexpr std::size_t max_fractions = 4u;
+
+    /* Key */
+    char pattern[max_pattern];
+    std::size_t pattern_size = max_pattern + 1u; /* Invalid */
+    unsigned digits = 0u;
+    std::int64_t seconds = 0;
+
+    /* Value */
+    char output[max_output];
+    std::size_t output_size = 0u;
+    std::size_t fractions[max_fractions];
+    std::size_t fraction_count = 0u;
+
+    bool matches(std::string_view p, unsigned d, std::int64_t s) const
+    {
+        return seconds == s && digits == d && pattern_size == p.size() &&
+               std::memcmp(pattern, p.data(), p.size()) == 0;
+    }
+
+    static time_cache& local()
+    {
+        static thread_local time_cache cache;
+        return cache;
+    }
+};
+
+/**
+ * Render `pattern` for a point in time given as seconds since epoch and
+ * `fraction` (in units of 10^-digits seconds) to `buffer`.
+ *
+ * Returns the size of the rendered string.
+ */
+inline std::size_t render_cached(std::string_view pattern, std::int64_t seconds,
+                                 std::uint64_t fraction, unsigned digits,
+                                 char* buffer, std::size_t buffer_size)
+{
+    auto& cache = time_cache::local();
+    if (!cache.matches(pattern, digits, seconds)) {
+        if (pattern.size() > time_cache::max_pattern) {
+            /* Not cacheable: Render directly. */
+            std::size_t fractions[time_cache::max_fractions];
+            writer w{buffer, buffer, buffer + buffer_size};
+            const auto count = render_time(pattern, civil_from_seconds(seconds), digits, w, fractions, time_cache::max_fractions);
+
+            for (std::size_t i = 0u; i < count; ++i) {
+                writer fw{buffer, buffer + fractions[i], w.pos};
+                fw.put_uint(fraction, digits);
+            }
+            return w.size();
+        }
+
+        writer w{cache.output, cache.output, cache.output + time_cache::max_output};
+        cache.fraction_count = render_time(pattern, civil_from_seconds(seconds), digits,
+                                           w, cache.fractions, time_cache::max_fractions);
+        cache.output_size = w.size();
+
+        std::memcpy(cache.pattern, pattern.data(), pattern.size());
+        cache.pattern_size = pattern.size();
+        cache.digits = digits;
+        cache.seconds = seconds;
+    }
+
+    const auto size = std::min(cache.output_size, buffer_size);
+    std::memcpy(buffer, cache.output, size);
+
+    for (std::size_t i = 0u; i < cache.fraction_count; ++i) {
+        writer fw{buffer, buffer + std::min(cache.fractions[i], size), buffer + size};
+        fw.put_uint(fraction, digits);
+    }
+
+    return size;
+}
+
+/**
+ * Splits a chrono format spec into the generic part (fill, justify and
+ * width; passed on to formatter_base) and the pattern starting at the
+ * first '%'.
+ */
+struct pattern_spec
+{
+    std::string_view pattern;
+
+    pattern_spec(std::string_view& sv)
+    {
+        const auto pos = sv.find('%');
+        if (pos != std::string_view::npos) {
+            pattern = sv.substr(pos);
+            sv = sv.substr(0u, pos);
+        }
+    }
+};
+
+template <class _Period>
+void put_unit(writer& w)
+{
+    if constexpr (std::is_same_v<_Period, std::nano>) w.put("ns");
+    else if constexpr (std::is_same_v<_Period, std::micro>) w.put("us");
+    else if constexpr (std::is_same_v<_Period, std::milli>) w.put("ms");
+    else if constexpr (std::is_same_v<_Period, std::ratio<1>>) w.put("s");
+    else if constexpr (std::is_same_v<_Period, std::ratio<60>>) w.put("min");
+    else if constexpr (std::is_same_v<_Period, std::ratio<3600>>) w.put("h");
+    else if constexpr (std::is_same_v<_Period, std::ratio<86400>>) w.put("d");
+    else if constexpr (_Period::den == 1) {
+        w.put('['); w.put_int(_Period::num, 0u); w.put("]s");
+    } else {
+        w.put('['); w.put_int(_Period::num, 0u); w.put('/'); w.put_int(_Period::den, 0u); w.put("]s");
+    }
+}
+
+}
+
+namespace stx
+{
+
+/**
+ * System clock time points, rendered in UTC without locale calls.
+ *
+ * Format: {:[fill][<>^][width]<pattern>}, the pattern starts at the first '%'.
+ *   %Y %y  Year (4 and 2 digits)    %a %A  Weekday (short, long)
+ *   %m     Month                    %b %B  Month name (short, long)
+ *   %d     Day                      %z %Z  "+0000", "UTC"
+ *   %H     Hour (24h)               %F     %Y-%m-%d
+ *   %M     Minute                   %T     %H:%M:%S
+ *   %S     Second                   %%     '%'
+ *   %f     Fractional seconds, one digit per decimal place of the
+ *          time point's precision (e.g. 3 for milliseconds)
+ *
+ * The default pattern is "%F %T", followed by ".%f" for sub-second precision.
+ *
+ * Example:
+ *   format("{:%FT%T.%fZ}", time_point_cast<milliseconds>(now)) => "2024-02-29T13:45:07.123Z"
+ *
+ * The rendered second is cached per thread, formatting time points within
+ * the same second only patches the fractional digits.
+ *
+ * Rendered time points are limited to 256 chars.
+ */
+template <class _Duration>
+struct formatter<std::chrono::time_point<std::chrono::system_clock, _Duration>> : chrono_impl::pattern_spec, formatter_base
+{
+    static constexpr unsigned digits = chrono_impl::fraction_digits<_Duration>();
+
+    formatter(std::string_view& sv)
+        : chrono_impl::pattern_spec(sv)
+        , formatter_base(sv)
+    {
+        if (!justify)
+            justify = '<';
+
+        if (pattern.empty())
+            pattern = digits ? "%F %T.%f" : "%F %T";
+    }
+
+    template <class _Iter>
+    _Iter format(const std::chrono::time_point<std::chrono::system_clock, _Duration>& value, _Iter out)
+    {
+        using namespace std::chrono;
+        using fraction_type = duration<std::int64_t, std::ratio<1, chrono_impl::pow10(digits)>>;
+
+        const auto since_epoch = value.time_since_epoch();
+        auto seconds = duration_cast<std::chrono::seconds>(since_epoch);
+        if (seconds > since_epoch)
+            seconds -= std::chrono::seconds(1); /* Round towards negative infinity. */
+
+        const auto fraction = duration_cast<fraction_type>(since_epoch - seconds).count();
+
+        char buffer[chrono_impl::time_cache::max_output];
+        const auto size = chrono_impl::render_cached(pattern, seconds.count(), static_cast<std::uint64_t>(fraction),
+                                                     digits, buffer, sizeof(buffer));
+        return write_padded(buffer, size, out);
+    }
+};
+
+/**
+ * Durations.
+ *
+ * Format: {:[fill][<>^][width]<pattern>}, the pattern starts at the first '%'.
+ *   %Q  Tick count              %H  Hours (total)
+ *   %q  Unit suffix (e.g. ms)   %M  Minutes (0-59)
+ *   %T  %H:%M:%S                %S  Seconds (0-59)
+ *   %%  '%'                     %f  Fractional seconds (see time points)
+ *
+ * The default pattern is "%Q%q". Negative durations are prefixed with '-'.
+ *
+ * Example:
+ *   format("{}", 42ms) => "42ms"
+ *   format("{:%T.%f}", 3723004ms) => "01:02:03.004"
+ */
+template <class _Rep, class _Period>
+struct formatter<std::chrono::duration<_Rep, _Period>> : chrono_impl::pattern_spec, formatter_base
+{
+    using duration_type = std::chrono::duration<_Rep, _Period>;
+
+    static constexpr unsigned digits = chrono_impl::fraction_digits<duration_type>();
+
+    formatter(std::string_view& sv)
+        : chrono_impl::pattern_spec(sv)
+        , formatter_base(sv)
+    {
+        if (!justify)
+            justify = '>';
+
+        if (pattern.empty())
+            pattern = "%Q%q";
+    }
+
+    template <class _Iter>
+    _Iter format(const duration_type& value, _Iter out)
+    {
+        using namespace std::chrono;
+        using fraction_type = duration<std::uint64_t, std::ratio<1, chrono_impl::pow10(digits)>>;
+
+        const auto negative = value < duration_type::zero();
+        const auto abs = negative ? -value : value;
+        const auto secs = duration_cast<seconds>(abs);
+
+        char buffer[chrono_impl::time_cache::max_output];
+        chrono_impl::writer w{buffer, buffer, buffer + sizeof(buffer)};
+        if (negative)
+            w.put('-');
+
+        for (std::size_t i = 0u; i < pattern.size(); ++i) {
+            if (pattern[i] != '%' || i + 1u == pattern.size()) {
+                w.put(pattern[i]);
+                continue;
+            }
+
+            const auto hours = static_cast<std::uint64_t>(secs.count() / 3600);
+            const auto minutes = static_cast<unsigned>(secs.count() / 60 % 60);
+            const auto seconds = static_cast<unsigned>(secs.count() % 60);
+
+            switch (pattern[++i]) {
+            case 'Q':
+                if constexpr (std::is_floating_point_v<_Rep>) {
+                    std::string_view spec;
+                    formatter<_Rep> f(spec);
+                    w.pos = f.format(abs.count(), format_impl::truncating_iterator<char*>(
+                        w.pos, static_cast<std::size_t>(w.end - w.pos))).out;
+                } else {
+                    w.put_uint(static_cast<std::uint64_t>(abs.count()), 0u);
+                }
+                break;
+            case 'q': chrono_impl::put_unit<typename _Period::type>(w); break;
+            case 'H': w.put_uint(hours, 2u); break;
+            case 'M': w.put_uint(minutes, 2u); break;
+            case 'S': w.put_uint(seconds, 2u); break;
+            case 'T':
+                w.put_uint(hours, 2u); w.put(':'); w.put_uint(minutes, 2u); w.put(':'); w.put_uint(seconds, 2u);
+                break;
+            case 'f':
+                if (digits)
+                    w.put_uint(duration_cast<fraction_type>(abs - secs).count(), digits);
+                break;
+            case '%': w.put('%'); break;
+            default:
+                w.put('%');
+                w.put(pattern[i]);
+                break;
+            }
+        }
+
+        return write_padded(buffer, w.size(), out);
+    }
+};
+
+}
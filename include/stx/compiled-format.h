@@ -0,0 +1,298 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "format.h"
+
+namespace stx
+{
+
+/**
+ * Format string, parsed once into a list of instructions (literal
+ * text and replacement fields) for repeated formatting of runtime
+ * format strings, e.g. localized messages loaded at startup.
+ *
+ * On first use, the formatters of all fields are constructed (parsing
+ * their format specs) for the argument types used and cached; calls
+ * with the same argument types only render. Calls with other argument
+ * types construct their formatters per call.
+ *
+ * Output is identical to `format(pattern, args...)`, except that fields
+ * referring to no argument throw std::invalid_argument on first use
+ * (instead of being left empty), as the pattern is not checked at
+ * compile time.
+ *
+ * Example:
+ *   const stx::compiled_format cf(load_message("greeting")); // "Hello, {:>8}!"
+ *   stx::format(cf, name) => "Hello,   Johann!"
+ *
+ * Note: Cached formatters are shared between threads and must not
+ *       modify themselves in `format` (the built-in formatters don't).
+ */
+class compiled_format
+{
+public:
+    explicit compiled_format(std::string_view fmt)
+        : pattern_(fmt)
+    {
+        compile();
+    }
+
+    compiled_format(const compiled_format& other)
+        : pattern_(other.pattern_)
+        , instructions_(other.instructions_)
+    {}
+
+    compiled_format& operator=(const compiled_format& other)
+    {
+        if (this != &other) {
+            reset();
+            pattern_ = other.pattern_;
+            instructions_ = other.instructions_;
+        }
+        return *this;
+    }
+
+    ~compiled_format()
+    {
+        reset();
+    }
+
+    /**
+     * The format string.
+     */
+    std::string_view pattern() const
+    {
+        return pattern_;
+    }
+
+    /**
+     * Returns true if all replacement fields refer to an argument
+     * of the argument list `_Args`.
+     */
+    template <class... _Args>
+    bool accepts() const
+    {
+        for (const auto& i : instructions_)
+            if (i.index != literal && i.index >= sizeof...(_Args))
+                return false;
+        return true;
+    }
+
+    /**
+     * See `stx::format_to`.
+     *
+     * Throws std::invalid_argument if a replacement field refers to no
+     * argument (see `accepts`), checked once per argument type list.
+     */
+    template <class _Iter, class... _Args>
+    _Iter format_to(_Iter out, const _Args& ...args) const
+    {
+        const std::tuple<const _Args&...> tuple(args...);
+
+        if constexpr (sizeof...(_Args) == 0u) {
+            (void)tuple;
+            validate<>();
+            for (const auto& i : instructions_)
+                if (i.index == literal)
+                    out = format_impl::write(out, pattern_.data() + i.offset, i.size);
+            return out;
+        } else {
+            using bound_type = bound<std::decay_t<const _Args&>...>;
+
+            auto* cached = bound_.load(std::memory_order_acquire);
+            if (!cached) {
+                auto* created = new bound_type(*this);
+                if (bound_.compare_exchange_strong(cached, created, std::memory_order_acq_rel))
+                    cached = created;
+                else
+                    delete created;
+            }
+
+            if (cached->key == &type_key<std::decay_t<const _Args&>...>)
+                return static_cast<bound_type*>(cached)->render(*this, tuple, out);
+
+            /* Other argument types than the cached ones. */
+            bound_type uncached(*this);
+            return uncached.render(*this, tuple, out);
+        }
+    }
+
+private:
+    static constexpr std::uint32_t literal = ~std::uint32_t(0u);
+
+    /**
+     * Literal text or replacement field, referencing `pattern_`
+     * by offset and size (text or format spec).
+     */
+    struct instruction
+    {
+        std::uint32_t offset;
+        std::uint32_t size;
+        std::uint32_t index; /* Argument index or `literal`. */
+    };
+
+    template <class... _Types>
+    static inline const char type_key = 0;
+
+    /**
+     * Formatters of all fields, for one argument type list.
+     */
+    struct bound_base
+    {
+        const void* key;
+        void (*destroy)(bound_base*);
+    };
+
+    template <class... _Types>
+    struct bound : bound_base
+    {
+        using formatter_variant = std::variant<std::monostate, formatter<_Types>...>;
+
+        /* One per instruction, monostate for literals.
+         * Argument N uses alternative N + 1. */
+        mutable std::vector<formatter_variant> formatters;
+
+        explicit bound(const compiled_format& cf)
+            : bound_base{&type_key<_Types...>, [](bound_base* b) { delete static_cast<bound*>(b); }}
+        {
+            cf.validate<_Types...>();
+
+            formatters.resize(cf.instructions_.size());
+            for (std::size_t i = 0u; i < formatters.size(); ++i) {
+                const auto& instr = cf.instructions_[i];
+                if (instr.index != literal)
+                    emplace(formatters[i], instr.index, cf.spec(instr), std::index_sequence_for<_Types...>());
+            }
+        }
+
+        template <std::size_t _Index>
+        static void emplace_at(formatter_variant& v, std::string_view spec)
+        {
+            v.template emplace<_Index + 1u>(spec);
+        }
+
+        template <std::size_t... _Index>
+        static void emplace(formatter_variant& v, std::size_t index, std::string_view spec, std::index_sequence<_Index...>)
+        {
+            using emplace_fn = void (*)(formatter_variant&, std::string_view);
+            static constexpr emplace_fn table[] = {&emplace_at<_Index>...};
+
+            table[index](v, spec);
+        }
+
+        template <std::size_t _Index, class _Tuple, class _Iter>
+        static _Iter format_at(formatter_variant& v, const _Tuple& t, _Iter out)
+        {
+            return format_impl::invoke_format(std::get<_Index + 1u>(v), std::get<_Index>(t), out);
+        }
+
+        template <class _Tuple, class _Iter, std::size_t... _Index>
+        static _Iter format_arg(formatter_variant& v, const _Tuple& t, _Iter out, std::index_sequence<_Index...>)
+        {
+            using format_fn = _Iter (*)(formatter_variant&, const _Tuple&, _Iter);
+            static constexpr format_fn table[] = {&format_at<_Index, _Tuple, _Iter>...};
+
+            return table[v.index() - 1u](v, t, out);
+        }
+
+        template <class _Tuple, class _Iter>
+        _Iter render(const compiled_format& cf, const _Tuple& t, _Iter out) const
+        {
+            for (std::size_t i = 0u; i < formatters.size(); ++i) {
+                const auto& instr = cf.instructions_[i];
+                if (instr.index == literal)
+                    out = format_impl::write(out, cf.pattern_.data() + instr.offset, instr.size);
+                else if (formatters[i].index() != 0u)
+                    out = format_arg(formatters[i], t, out, std::index_sequence_for<_Types...>());
+            }
+            return out;
+        }
+    };
+
+    template <class... _Args>
+    void validate() const
+    {
+        if (!accepts<_Args...>())
+            throw std::invalid_argument("stx::compiled_format: field without argument in '" + pattern_ + "'");
+    }
+
+    std::string_view spec(const instruction& i) const
+    {
+        return std::string_view(pattern_).substr(i.offset, i.size);
+    }
+
+    void compile()
+    {
+        const auto offset = [this](std::string_view part) {
+            return static_cast<std::uint32_t>(part.data() - pattern_.data());
+        };
+
+        format_impl::parse_format(pattern_,
+            [&](std::string_view text) {
+                /* Merge adjacent literal runs. */
+                if (!instructions_.empty()) {
+                    auto& last = instructions_.back();
+                    if (last.index == literal && last.offset + last.size == offset(text)) {
+                        last.size += static_cast<std::uint32_t>(text.size());
+                        return;
+                    }
+                }
+
+                instructions_.push_back({offset(text), static_cast<std::uint32_t>(text.size()), literal});
+            },
+            [&](std::size_t index, std::string_view spec) {
+                const auto spec_offset = spec.data() ? offset(spec) : 0u;
+                instructions_.push_back({spec_offset, static_cast<std::uint32_t>(spec.size()),
+                                         static_cast<std::uint32_t>(std::min<std::size_t>(index, literal - 1u))});
+            });
+    }
+
+    void reset()
+    {
+        if (auto* b = bound_.exchange(nullptr))
+            b->destroy(b);
+    }
+
+    std::string pattern_;
+    std::vector<instruction> instructions_;
+    mutable std::atomic<bound_base*> bound_{nullptr};
+};
+
+/**
+ * See `format`.
+ */
+template <class _Iter, class... _Args>
+_Iter format_to(_Iter out, const compiled_format& fmt, const _Args& ...args)
+{
+    return fmt.format_to(out, args...);
+}
+
+/**
+ * See `format` and `compiled_format`.
+ *
+ * Example:
+ *   format(compiled_format("{1} {0}"), "a", 1) => "1 a"
+ */
+template <class _String = std::string, class... _Args>
+_String format(const compiled_format& fmt, const _Args& ...args)
+{
+    _String out;
+    out.reserve(fmt.pattern().size());
+
+    fmt.format_to(std::back_inserter(out), args...);
+
+    return out;
+}
+
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace stx
+{
+
+/**
+ * Thread-safe hash map using lock striping.
+ *
+ * Keys are distributed over shards, each an `std::unordered_map`
+ * guarded by its own `std::shared_mutex`. Readers never block each
+ * other and only wait for writers of the same shard.
+ *
+ * Values are returned by copy (references into the map would not be
+ * safe); use `visit` to access a value in place.
+ *
+ * Example:
+ *   stx::concurrent_map<std::string, int> m;
+ *   m.insert_or_assign("a", 1);
+ *   stx::value_or(m, std::string("a"), 0) => 1
+ */
+template <class _Key, class _Value, class _Hash = std::hash<_Key>, class _Equal = std::equal_to<_Key>>
+class concurrent_map
+{
+public:
+    using key_type = _Key;
+    using mapped_type = _Value;
+
+    /**
+     * @param shards  Number of shards (rounded up to a power of two).
+     */
+    explicit concurrent_map(std::size_t shards = 16u)
+    {
+        while ((std::size_t(1u) << shard_bits_) < shards && shard_bits_ < 16u)
+            ++shard_bits_;
+        shards_ = std::make_unique<shard[]>(std::size_t(1u) << shard_bits_);
+    }
+
+    concurrent_map(const concurrent_map&) = delete;
+    concurrent_map& operator=(const concurrent_map&) = delete;
+
+    /**
+     * Insert `value` for `key`, if the key is not present yet.
+     * Returns true if inserted.
+     */
+    template <class _V>
+    bool insert(const _Key& key, _V&& value)
+    {
+        auto& sh = shard_of(key);
+        std::unique_lock lock(sh.mutex);
+        return sh.map.emplace(key, std::forward<_V>(value)).second;
+    }
+
+    /**
+     * Insert or replace the value for `key`.
+     */
+    template <class _V>
+    void insert_or_assign(const _Key& key, _V&& value)
+    {
+        auto& sh = shard_of(key);
+        std::unique_lock lock(sh.mutex);
+        sh.map.insert_or_assign(key, std::forward<_V>(value));
+    }
+
+    /**
+     * Remove `key`. Returns true if removed.
+     */
+    bool erase(const _Key& key)
+    {
+        auto& sh = shard_of(key);
+        std::unique_lock lock(sh.mutex);
+        return sh.map.erase(key) > 0u;
+    }
+
+    /**
+     * Returns a copy of the value for `key`, or `fallback` if not found.
+     * See `stx::value_or`.
+     */
+    template <class _FallbackType>
+    _Value value_or(const _Key& key, _FallbackType&& fallback) const
+    {
+        const auto& sh = shard_of(key);
+        std::shared_lock lock(sh.mutex);
+
+        auto iter = sh.map.find(key);
+        if (iter != sh.map.end())
+            return iter->second;
+        return std::forward<_FallbackType>(fallback);
+    }
+
+    /**
+     * Returns a copy of the value for `key`, if found.
+     */
+    std::optional<_Value> get(const _Key& key) const
+    {
+        const auto& sh = shard_of(key);
+        std::shared_lock lock(sh.mutex);
+
+        auto iter = sh.map.find(key);
+        if (iter != sh.map.end())
+            return iter->second;
+        return {};
+    }
+
+    bool contains(const _Key& key) const
+    {
+        const auto& sh = shard_of(key);
+        std::shared_lock lock(sh.mutex);
+        return sh.map.find(key) != sh.map.end();
+    }
+
+    /**
+     * Calls `f(const _Value&)` for the value of `key` under a shared
+     * lock. Returns false if `key` was not found.
+     *
+     * Note: `f` must not access the map.
+     */
+    template <class _Fn>
+    bool visit(const _Key& key, _Fn&& f) const
+    {
+        const auto& sh = shard_of(key);
+        std::shared_lock lock(sh.mutex);
+
+        auto iter = sh.map.find(key);
+        if (iter == sh.map.end())
+            return false;
+
+        f(iter->second);
+        return true;
+    }
+
+    /**
+     * Calls `f(_Value&)` for the value of `key` under an exclusive
+     * lock. Returns false if `key` was not found.
+     *
+     * Note: `f` must not access the map.
+     */
+    template <class _Fn>
+    bool update(const _Key& key, _Fn&& f)
+    {
+        auto& sh = shard_of(key);
+        std::unique_lock lock(sh.mutex);
+
+        auto iter = sh.map.find(key);
+        if (iter == sh.map.end())
+            return false;
+
+        f(iter->second);
+        return true;
+    }
+
+    /**
+     * Number of entries. Not a snapshot if the map is modified concurrently.
+     */
+    std::size_t size() const
+    {
+        std::size_t n = 0u;
+        for (std::size_t i = 0u; i < shard_count(); ++i) {
+            std::shared_lock lock(shards_[i].mutex);
+            n += shards_[i].map.size();
+        }
+        return n;
+    }
+
+    void clear()
+    {
+        for (std::size_t i = 0u; i < shard_count(); ++i) {
+            std::unique_lock lock(shards_[i].mutex);
+            shards_[i].map.clear();
+        }
+    }
+
+private:
+    struct alignas(64) shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<_Key, _Value, _Hash, _Equal> map;
+    };
+
+    std::size_t shard_count() const
+    {
+        return std::size_t(1u) << shard_bits_;
+    }
+
+    std::size_t shard_index(const _Key& key) const
+    {
+        if (shard_bits_ == 0u)
+            return 0u;
+
+        /* Fibonacci hashing: std::hash is the identity for integers. */
+        const auto h = static_cast<std::uint64_t>(_Hash()(key)) * 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(h >> (64u - shard_bits_));
+    }
+
+    shard& shard_of(const _Key& key)
+    {
+        return shards_[shard_index(key)];
+    }
+
+    const shard& shard_of(const _Key& key) const
+    {
+        return shards_[shard_index(key)];
+    }
+
+    unsigned shard_bits_ = 0u;
+    std::unique_ptr<shard[]> shards_;
+};
+
+/**
+ * Returns a copy of the value for key `k`, or fallback value `v` if no
+ * value for the key could be found. See `value_or` in `map.h`.
+ */
+template <class _KeyType, class _ValueType, class _Hash, class _Equal, class _FallbackType>
+_ValueType value_or(const concurrent_map<_KeyType, _ValueType, _Hash, _Equal>& c,
+                    const _KeyType& k,
+                    _FallbackType&& v)
+{
+    return c.value_or(k, std::forward<_FallbackType>(v));
+}
+
+template <class _KeyType, class _ValueType, class _Hash, class _Equal, class _FallbackType>
+_ValueType value_or(concurrent_map<_KeyType, _ValueType, _Hash, _Equal>&& c,
+                    const _KeyType& k,
+                    _FallbackType v)
+{
+    return c.value_or(k, std::move(v));
+}
+
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "simd_impl.h"
+
+namespace stx
+{
+
+namespace csv_impl
+{
+
+struct masks
+{
+    std::uint64_t quote;
+    std::uint64_t delim;
+    std::uint64_t newline;
+};
+
+/**
+ * Bit i of the result is the XOR of bits 0 to i of `x`.
+ */
+inline std::uint64_t prefix_xor(std::uint64_t x)
+{
+    x ^= x << 1u;
+    x ^= x << 2u;
+    x ^= x << 4u;
+    x ^= x << 8u;
+    x ^= x << 16u;
+    x ^= x << 32u;
+    return x;
+}
+
+/**
+ * Returns the quotes of `quote` that are structural, in order: quotes
+ * inside quoted fields, quotes opening a field (bit set in `starts`)
+ * and quotes directly following a closing quote (escaped quotes).
+ * Other quotes are content. `inside` is the state before the first bit.
+ */
+inline std::uint64_t field_quotes(std::uint64_t quote, std::uint64_t starts, bool inside)
+{
+    std::uint64_t result = 0u;
+    std::uint64_t reopen = 0u;
+    for (; quote; quote &= quote - 1u) {
+        const auto bit = quote & (~quote + 1u);
+        if (inside || (starts & bit) || bit == reopen) {
+            result |= bit;
+            inside = !inside;
+            reopen = inside ? 0u : bit << 1u;
+        }
+    }
+    return result;
+}
+
+#if defined(STX_SIMD_NEON)
+inline std::uint64_t movemask64(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d)
+{
+    static const std::uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const auto w = vld1q_u8(weights);
+    auto ab = vpaddq_u8(vandq_u8(a, w), vandq_u8(b, w));
+    auto cd = vpaddq_u8(vandq_u8(c, w), vandq_u8(d, w));
+    auto sum = vpaddq_u8(ab, cd);
+    sum = vpaddq_u8(sum, sum);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+#endif
+
+/**
+ * Classify 64 chars starting at `p`.
+ */
+inline masks classify(const char* p, char delim)
+{
+#if defined(STX_SIMD_AVX2)
+    const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    auto mask = [&](char c) {
+        const auto v = _mm256_set1_epi8(c);
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)))) |
+               static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)))) << 32u;
+    };
+    return {mask('"'), mask(delim), mask('\n')};
+#elif defined(STX_SIMD_SSE2)
+    __m128i v[4];
+    for (auto i = 0u; i < 4u; ++i)
+        v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16u * i));
+    auto mask = [&](char c) {
+        const auto cv = _mm_set1_epi8(c);
+        std::uint64_t m = 0u;
+        for (auto i = 0u; i < 4u; ++i)
+            m |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], cv)))) << (16u * i);
+        return m;
+    };
+    return {mask('"'), mask(delim), mask('\n')};
+#elif defined(STX_SIMD_NEON)
+    uint8x16_t v[4];
+    for (auto i = 0u; i < 4u; ++i)
+        v[i] = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p + 16u * i));
+    auto mask = [&](char c) {
+        const auto cv = vdupq_n_u8(static_cast<std::uint8_t>(c));
+        return movemask64(vceqq_u8(v[0], cv), vceqq_u8(v[1], cv), vceqq_u8(v[2], cv), vceqq_u8(v[3], cv));
+    };
+    return {mask('"'), mask(delim), mask('\n')};
+#else
+    masks m{0u, 0u, 0u};
+    for (auto i = 0u; i < 64u; ++i) {
+        const auto bit = std::uint64_t(1u) << i;
+        m.quote |= p[i] == '"' ? bit : 0u;
+        m.delim |= p[i] == delim ? bit : 0u;
+        m.newline |= p[i] == '\n' ? bit : 0u;
+    }
+    return m;
+#endif
+}
+
+}
+
+/**
+ * Streaming RFC 4180 CSV reader.
+ *
+ * Input is classified 64 chars at a time into quote, delimiter and
+ * newline bitmaps (using SIMD, if available); a prefix XOR over the
+ * quote bits masks out delimiters and newlines inside quoted fields.
+ * Blocks with quotes in the middle of unquoted fields (which are
+ * content) are resolved bit by bit.
+ *
+ * Fields are `std::string_view`s into the reader's buffer, quoted fields
+ * containing escaped quotes ("") are unescaped into a scratch buffer.
+ * Fields stay valid until the next call to `read_row` or `feed`.
+ * Line endings may be "\n" or "\r\n"; an empty line is a row without
+ * fields. Quotes are only special at the start of a field.
+ *
+ * Example:
+ *   stx::csv_reader reader;
+ *   std::vector<std::string_view> row;
+ *   while (read(fd, chunk)) {
+ *       reader.feed(chunk);
+ *       while (reader.read_row(row))
+ *           use(row);
+ *   }
+ *   reader.finish();
+ *   while (reader.read_row(row))
+ *       use(row);
+ */
+class csv_reader
+{
+public:
+    /**
+     * @param delimiter    Field delimiter.
+     * @param removeEmpty  Skip empty fields (see `split`).
+     */
+    explicit csv_reader(char delimiter = ',', bool removeEmpty = false)
+        : delimiter_(delimiter)
+        , removeEmpty_(removeEmpty)
+    {}
+
+    /**
+     * Append input. Invalidates fields returned before.
+     */
+    void feed(std::string_view data)
+    {
+        /* Keep the scan state, only the last partial block is rescanned. */
+        if (const auto n = std::min(pos_, block_); n > 0u) {
+            buffer_.erase(0u, n);
+            pos_ -= n;
+            scan_ -= n;
+            block_ -= n;
+            for (auto& end : ends_)
+                end -= n;
+        }
+
+        buffer_.append(data.data(), data.size());
+    }
+
+    /**
+     * Mark the end of input; the last row does not need to end with a
+     * newline.
+     */
+    void finish()
+    {
+        finished_ = true;
+    }
+
+    /**
+     * Returns true if all input has been read.
+     */
+    bool done() const
+    {
+        return finished_ && pos_ >= buffer_.size();
+    }
+
+    /**
+     * Read the next complete row into `fields` (which is cleared first).
+     * Returns false if more input is needed (or all input was read).
+     */
+    template <class _Container>
+    bool read_row(_Container& fields)
+    {
+        fields.clear();
+        if (!find_row())
+            return false;
+
+        const auto row_end = ends_.back();
+        scratch_.clear();
+        scratch_.reserve(row_end - pos_);
+
+        const std::string_view buffer(buffer_);
+        auto start = pos_;
+        for (auto end : ends_) {
+            auto raw = buffer.substr(start, end - start);
+            if (end == row_end && end < buffer.size() && !raw.empty() && raw.back() == '\r')
+                raw.remove_suffix(1u);
+
+            /* A row consisting of an empty line has no fields. */
+            if (ends_.size() == 1u && raw.empty())
+                break;
+
+            const auto field = unquote(raw);
+            if (!removeEmpty_ || !field.empty())
+                fields.push_back(field);
+            start = end + 1u;
+        }
+
+        pos_ = std::min(row_end + 1u, buffer_.size());
+        ends_.clear();
+        return true;
+    }
+
+private:
+    /**
+     * Undo `next_block` of a partial block, to scan it again once more
+     * input arrived. All its bits must have been visited.
+     */
+    void rewind_partial_block()
+    {
+        if (scan_ - block_ == 64u)
+            return;
+
+        while (!ends_.empty() && ends_.back() >= block_)
+            ends_.pop_back();
+
+        scan_ = block_;
+        inside_ = last_.inside;
+        start_ = last_.start;
+        closed_ = last_.closed;
+    }
+
+    /**
+     * Collect the field end positions of the row at `pos_` into `ends_`.
+     */
+    bool find_row()
+    {
+        for (;;) {
+            while (bits_ == 0u) {
+                if (scan_ >= buffer_.size()) {
+                    if (finished_ && pos_ < buffer_.size()) {
+                        ends_.push_back(buffer_.size());
+                        return true;
+                    }
+
+                    rewind_partial_block();
+                    return false;
+                }
+
+                next_block();
+            }
+
+            const auto p = block_ + simd_impl::ctz(bits_);
+            bits_ &= bits_ - 1u;
+
+            ends_.push_back(p);
+            if (buffer_[p] == '\n')
+                return true;
+        }
+    }
+
+    void next_block()
+    {
+        const auto n = std::min<std::size_t>(buffer_.size() - scan_, 64u);
+        csv_impl::masks m;
+        if (n == 64u) {
+            m = csv_impl::classify(buffer_.data() + scan_, delimiter_);
+        } else {
+            char tail[64] = {};
+            std::memcpy(tail, buffer_.data() + scan_, n);
+            m = csv_impl::classify(tail, delimiter_);
+        }
+
+        const auto valid = n == 64u ? ~std::uint64_t(0u) : (std::uint64_t(1u) << n) - 1u;
+        const auto ends = m.delim | m.newline;
+        const auto starts = (ends << 1u) | start_;
+
+        /* Quotes outside of quoted fields must be at a field start or
+         * follow a closing quote (""). */
+        auto quote = m.quote & valid;
+        const auto before = csv_impl::prefix_xor(quote) ^ quote ^ inside_;
+        if (quote & ~before & ~starts & ~((quote << 1u) | closed_))
+            quote = csv_impl::field_quotes(quote, starts | closed_, inside_ != 0u);
+
+        const auto inside = csv_impl::prefix_xor(quote) ^ inside_;
+        last_ = {inside_, start_, closed_};
+        inside_ = (inside >> 63u) ? ~std::uint64_t(0u) : 0u;
+        start_ = ends >> 63u;
+        closed_ = (quote & ~inside) >> 63u;
+
+        bits_ = ends & ~inside & valid;
+        if (pos_ > scan_) /* Rescanned block, skip ends of read rows */
+            bits_ &= ~std::uint64_t(0u) << (pos_ - scan_);
+        block_ = scan_;
+        scan_ += n;
+    }
+
+    std::string_view unquote(std::string_view raw)
+    {
+        if (raw.empty() || raw.front() != '"')
+            return raw;
+
+        raw.remove_prefix(1u);
+        if (!raw.empty() && raw.back() == '"')
+            raw.remove_suffix(1u);
+
+        if (raw.find('"') == std::string_view::npos)
+            return raw;
+
+        /* Unescape "" (scratch_ has been reserved for the whole row). */
+        const auto offset = scratch_.size();
+        for (std::size_t i = 0u; i < raw.size(); ++i) {
+            scratch_.push_back(raw[i]);
+            if (raw[i] == '"' && i + 1u < raw.size() && raw[i + 1u] == '"')
+                ++i;
+        }
+        return std::string_view(scratch_.data() + offset, scratch_.size() - offset);
+    }
+
+    char delimiter_;
+    bool removeEmpty_;
+    bool finished_ = false;
+
+    std::string buffer_;
+    std::size_t pos_ = 0u;   /* Start of the next row */
+    std::size_t scan_ = 0u;  /* Start of the next block to classify */
+    std::size_t block_ = 0u; /* Start of the current block */
+    std::uint64_t bits_ = 0u;   /* Unvisited field ends of the current block */
+    std::uint64_t inside_ = 0u; /* All ones, if the current block ends inside quotes */
+    std::uint64_t start_ = 1u;  /* 1, if the next block starts a field */
+    std::uint64_t closed_ = 0u; /* 1, if the current block ends with a closing quote */
+    struct {
+        std::uint64_t inside, start, closed;
+    } last_ = {0u, 1u, 0u};     /* State before the current block */
+    std::vector<std::size_t> ends_;
+    std::string scratch_;
+};
+
+}
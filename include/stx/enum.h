@@ -0,0 +1,385 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "formatter.h"
+#include "static-map.h"
+#include "string.h"
+
+/**
+ * Register the names of the enumerators of enum `_Type`, enabling
+ * `formatter<_Type>`, `from_string<_Type>`, `enum_name` and
+ * `enum_from_string`. The enumerator names are taken from the spelling
+ * of the argument list at compile time.
+ *
+ * Must be used in the namespace of `_Type` (not in class scope).
+ *
+ * Example:
+ *   enum class color { red, green, blue };
+ *   STX_ENUM_NAMES(color, color::red, color::green, color::blue)
+ *
+ *   stx::format("{}", color::green) => "green"
+ *   stx::from_string<color>("blue") => color::blue
+ */
+#define STX_ENUM_NAMES(_Type, ...)                                              \
+    constexpr auto stx_enum_names(::stx::enum_impl::tag<_Type>)                 \
+    {                                                                           \
+        return ::stx::enum_impl::make_table<_Type>({__VA_ARGS__}, #__VA_ARGS__, false); \
+    }
+
+/**
+ * See `STX_ENUM_NAMES`, for flag enums: values which are no enumerator
+ * are formatted (and parsed) as "|"-joined list of enumerators.
+ *
+ * Example:
+ *   enum class access { none = 0, read = 1, write = 2, exec = 4 };
+ *   STX_ENUM_FLAGS(access, access::none, access::read, access::write, access::exec)
+ *
+ *   stx::format("{}", access(3)) => "read|write"
+ */
+#define STX_ENUM_FLAGS(_Type, ...)                                              \
+    constexpr auto stx_enum_names(::stx::enum_impl::tag<_Type>)                 \
+    {                                                                           \
+        return ::stx::enum_impl::make_table<_Type>({__VA_ARGS__}, #__VA_ARGS__, true); \
+    }
+
+namespace stx
+{
+
+namespace enum_impl
+{
+
+template <class _Enum>
+struct tag {};
+
+/* Only found by ADL, see STX_ENUM_NAMES */
+void stx_enum_names() = delete;
+
+template <class _Enum, std::size_t _N>
+struct table
+{
+    std::array<_Enum, _N> values{};
+    std::array<std::string_view, _N> names{};
+    bool flags = false;
+};
+
+constexpr bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+constexpr std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && is_space(s.front()))
+        s.remove_prefix(1u);
+    while (!s.empty() && is_space(s.back()))
+        s.remove_suffix(1u);
+    return s;
+}
+
+/**
+ * Build the name table from the enumerators `values` and their spelling
+ * `text` ("color::red, color::green, ...").
+ */
+template <class _Enum, std::size_t _N>
+constexpr table<_Enum, _N> make_table(const _Enum (&values)[_N], std::string_view text, bool flags)
+{
+    table<_Enum, _N> result;
+    result.flags = flags;
+
+    for (std::size_t i = 0u; i < _N; ++i) {
+        const auto end = text.find(',');
+        auto name = trim(text.substr(0u, end));
+
+        const auto scope = name.rfind(':');
+        if (scope != std::string_view::npos)
+            name = trim(name.substr(scope + 1u));
+
+        result.values[i] = values[i];
+        result.names[i] = name;
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1u);
+    }
+
+    return result;
+}
+
+template <class _Enum, class = void>
+struct is_registered : std::false_type {};
+
+template <class _Enum>
+struct is_registered<_Enum, std::enable_if_t<std::is_enum_v<_Enum>,
+    std::void_t<decltype(stx_enum_names(tag<_Enum>()))>>> : std::true_type {};
+
+template <class _Enum>
+inline constexpr bool is_registered_v = is_registered<_Enum>::value;
+
+template <class _Enum>
+struct info
+{
+    using underlying = std::underlying_type_t<_Enum>;
+
+    static constexpr auto table = stx_enum_names(tag<_Enum>());
+    static constexpr std::size_t size = table.values.size();
+    static_assert(size > 0u, "STX_ENUM_NAMES requires at least one enumerator");
+
+    static constexpr std::intmax_t value(std::size_t i)
+    {
+        return static_cast<std::intmax_t>(static_cast<underlying>(table.values[i]));
+    }
+
+    static constexpr std::intmax_t min_value()
+    {
+        auto v = value(0u);
+        for (std::size_t i = 1u; i < size; ++i)
+            v = value(i) < v ? value(i) : v;
+        return v;
+    }
+
+    static constexpr std::intmax_t max_value()
+    {
+        auto v = value(0u);
+        for (std::size_t i = 1u; i < size; ++i)
+            v = value(i) > v ? value(i) : v;
+        return v;
+    }
+
+    static constexpr std::intmax_t min = min_value();
+    static constexpr std::uintmax_t range = static_cast<std::uintmax_t>(max_value() - min) + 1u;
+
+    /* Values spread over a small range are looked up by index. */
+    static constexpr bool dense = range <= 2u * size + 16u;
+
+    /* Name index + 1 by value - min, or 0 */
+    static constexpr auto make_index()
+    {
+        std::array<std::uint32_t, dense ? range : 0u> index{};
+        if constexpr (dense) {
+            for (std::size_t i = size; i-- > 0u;)
+                index[static_cast<std::size_t>(value(i) - min)] = static_cast<std::uint32_t>(i + 1u);
+        }
+        return index;
+    }
+
+    static constexpr auto index = make_index();
+
+    template <std::size_t... _I>
+    static constexpr auto make_lookup(std::index_sequence<_I...>)
+    {
+        return make_static_map<std::string_view, _Enum>({{table.names[_I], table.values[_I]}...});
+    }
+
+    static constexpr auto by_name = make_lookup(std::make_index_sequence<size>());
+
+    /* Sparse values are looked up in a static_map, which requires unique
+     * keys: of aliases, the first registered name is used. */
+    static constexpr bool is_first(std::size_t i)
+    {
+        for (std::size_t j = 0u; j < i; ++j)
+            if (value(j) == value(i))
+                return false;
+        return true;
+    }
+
+    static constexpr std::size_t count_unique()
+    {
+        std::size_t n = 0u;
+        for (std::size_t i = 0u; i < size; ++i)
+            n += is_first(i);
+        return n;
+    }
+
+    static constexpr std::size_t unique = count_unique();
+
+    static constexpr auto make_unique_indices()
+    {
+        std::array<std::size_t, unique> indices{};
+        for (std::size_t i = 0u, n = 0u; i < size; ++i)
+            if (is_first(i))
+                indices[n++] = i;
+        return indices;
+    }
+
+    template <std::size_t... _I>
+    static constexpr auto make_names(std::index_sequence<_I...>)
+    {
+        constexpr auto indices = make_unique_indices();
+        return make_static_map<_Enum, std::string_view>({{table.values[indices[_I]], table.names[indices[_I]]}...});
+    }
+
+    static constexpr auto make_by_value()
+    {
+        if constexpr (dense)
+            return nullptr;
+        else
+            return make_names(std::make_index_sequence<unique>());
+    }
+
+    static constexpr auto by_value = make_by_value();
+
+    static constexpr std::optional<std::string_view> name(_Enum v)
+    {
+        if constexpr (dense) {
+            const auto x = static_cast<std::intmax_t>(static_cast<underlying>(v));
+            const auto i = static_cast<std::uintmax_t>(x - min);
+            if (x >= min && i < range && index[static_cast<std::size_t>(i)] != 0u)
+                return table.names[index[static_cast<std::size_t>(i)] - 1u];
+        } else {
+            if (const auto* name = by_value.find(v))
+                return *name;
+        }
+        return {};
+    }
+};
+
+}
+
+/**
+ * Returns the name of enumerator `value`, if registered using
+ * `STX_ENUM_NAMES`.
+ */
+template <class _Enum>
+constexpr std::optional<std::string_view> enum_name(_Enum value)
+{
+    return enum_impl::info<_Enum>::name(value);
+}
+
+/**
+ * Returns the registered enumerators of `_Enum`, in order of
+ * registration.
+ */
+template <class _Enum>
+constexpr const auto& enum_values()
+{
+    return enum_impl::info<_Enum>::table.values;
+}
+
+/**
+ * Returns the enumerator named `name`. For flag enums, "|"-joined lists
+ * of names are accepted as well.
+ */
+template <class _Enum>
+constexpr std::optional<_Enum> enum_from_string(std::string_view name)
+{
+    using info = enum_impl::info<_Enum>;
+
+    if (const auto* v = info::by_name.find(enum_impl::trim(name)))
+        return *v;
+
+    if (!info::table.flags)
+        return {};
+
+    typename info::underlying bits = 0;
+    for (;;) {
+        const auto end = name.find('|');
+        const auto* v = info::by_name.find(enum_impl::trim(name.substr(0u, end)));
+        if (!v)
+            return {};
+
+        bits = static_cast<typename info::underlying>(bits | static_cast<typename info::underlying>(*v));
+        if (end == std::string_view::npos)
+            return static_cast<_Enum>(bits);
+        name.remove_prefix(end + 1u);
+    }
+}
+
+namespace impl
+{
+
+template <class _Enum>
+struct from_string<_Enum, std::enable_if_t<enum_impl::is_registered_v<_Enum>>>
+{
+    /* Unknown names yield `_Enum{}` (like 0 for unparsable ints) */
+    static auto from(const std::string& v)
+    {
+        return enum_from_string<_Enum>(v).value_or(_Enum{});
+    }
+};
+
+}
+
+/**
+ * Formats registered enums by name (see `STX_ENUM_NAMES`); supports the
+ * options of `std::string_view`. Unnamed values are formatted as number,
+ * those of flag enums as "|"-joined list of names (and a hex number for
+ * remaining bits).
+ */
+template <class _Type>
+struct formatter<_Type, std::enable_if_t<enum_impl::is_registered_v<_Type>>> : formatter<std::string_view>
+{
+    using formatter<std::string_view>::formatter;
+    using info = enum_impl::info<_Type>;
+    using underlying = typename info::underlying;
+
+    template <class _Iter>
+    _Iter format(_Type value, _Iter out)
+    {
+        if (const auto name = info::name(value))
+            return formatter<std::string_view>::format(*name, out);
+
+        const auto bits = static_cast<underlying>(value);
+        if (info::table.flags && bits != 0)
+            return format_flags(bits, out);
+
+        char buffer[24];
+        const auto size = static_cast<std::size_t>(std::to_chars(buffer, buffer + sizeof(buffer), bits).ptr - buffer);
+        return formatter<std::string_view>::format(std::string_view(buffer, size), out);
+    }
+
+private:
+    using unsigned_type = std::make_unsigned_t<underlying>;
+
+    /**
+     * Calls `f(std::string_view)` for each part of the "|"-joined list
+     * of flags `bits`, with a hex number of the remaining bits.
+     */
+    template <class _Fn>
+    static void for_each_flag_part(unsigned_type bits, _Fn&& f)
+    {
+        bool first = true;
+        for (std::size_t i = 0u; i < info::size && bits != 0u; ++i) {
+            const auto flag = static_cast<unsigned_type>(info::table.values[i]);
+            if (flag != 0u && (bits & flag) == flag) {
+                if (!std::exchange(first, false))
+                    f(std::string_view("|"));
+                f(info::table.names[i]);
+                bits = static_cast<unsigned_type>(bits & ~flag);
+            }
+        }
+
+        if (bits != 0u) {
+            char buffer[24] = {'0', 'x'};
+            const auto end = std::to_chars(buffer + 2, buffer + sizeof(buffer), bits, 16).ptr;
+            if (!first)
+                f(std::string_view("|"));
+            f(std::string_view(buffer, static_cast<std::size_t>(end - buffer)));
+        }
+    }
+
+    /* Two passes (width, then parts) to write without a buffer. */
+    template <class _Iter>
+    _Iter format_flags(underlying bits, _Iter out)
+    {
+        const auto value = static_cast<unsigned_type>(bits);
+
+        std::size_t width = 0u;
+        for_each_flag_part(value, [&width](std::string_view part) {
+            width += part.size();
+        });
+
+        out = this->justify_pre(width, out);
+        for_each_flag_part(value, [&out](std::string_view part) {
+            out = format_impl::write(out, part.data(), part.size());
+        });
+        return this->justify_post(width, out);
+    }
+};
+
+}
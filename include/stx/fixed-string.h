@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <algorithm>
+
+namespace stx
+{
+
+/**
+ * Fixed-capacity, null-terminated string stored inline (no heap allocation).
+ *
+ * Content exceeding capacity `_N` gets truncated.
+ *
+ * Example:
+ *   fixed_string<8> s("Hello");
+ *   s.append(", World!") => "Hello, W"
+ */
+template <std::size_t _N>
+struct fixed_string
+{
+    using value_type = char;
+    using size_type = std::size_t;
+    using iterator = char*;
+    using const_iterator = const char*;
+
+    constexpr fixed_string() = default;
+
+    constexpr fixed_string(std::string_view sv)
+    {
+        append(sv);
+    }
+
+    /**
+     * Append `sv`, truncating it to the remaining capacity.
+     */
+    constexpr fixed_string& append(std::string_view sv)
+    {
+        const auto n = std::min(sv.size(), _N - size_);
+        for (std::size_t i = 0u; i < n; ++i)
+            buffer_[size_ + i] = sv[i];
+
+        size_ += n;
+        buffer_[size_] = '\0';
+        return *this;
+    }
+
+    constexpr void push_back(char c)
+    {
+        if (size_ < _N) {
+            buffer_[size_++] = c;
+            buffer_[size_] = '\0';
+        }
+    }
+
+    /**
+     * Set size to `n` (clamped to capacity), e.g. after writing to `data()`.
+     */
+    constexpr void resize(std::size_t n)
+    {
+        size_ = std::min(n, _N);
+        buffer_[size_] = '\0';
+    }
+
+    constexpr void clear()
+    {
+        resize(0u);
+    }
+
+    constexpr char* data() { return buffer_; }
+    constexpr const char* data() const { return buffer_; }
+    constexpr const char* c_str() const { return buffer_; }
+
+    constexpr std::size_t size() const { return size_; }
+    constexpr std::size_t length() const { return size_; }
+    constexpr bool empty() const { return size_ == 0u; }
+    static constexpr std::size_t capacity() { return _N; }
+
+    constexpr char* begin() { return buffer_; }
+    constexpr char* end() { return buffer_ + size_; }
+    constexpr const char* begin() const { return buffer_; }
+    constexpr const char* end() const { return buffer_ + size_; }
+
+    constexpr char& operator[](std::size_t i) { return buffer_[i]; }
+    constexpr const char& operator[](std::size_t i) const { return buffer_[i]; }
+
+    constexpr operator std::string_view() const
+    {
+        return {buffer_, size_};
+    }
+
+    constexpr std::string_view view() const
+    {
+        return {buffer_, size_};
+    }
+
+    friend constexpr bool operator==(const fixed_string& lhs, std::string_view rhs)
+    {
+        return lhs.view() == rhs;
+    }
+
+    friend constexpr bool operator!=(const fixed_string& lhs, std::string_view rhs)
+    {
+        return lhs.view() != rhs;
+    }
+
+private:
+    char buffer_[_N + 1u] = {};
+    std::size_t size_ = 0u;
+};
+
+}
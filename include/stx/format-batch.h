@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "compiled-format.h"
+#include "format_sink_impl.h"
+#include "io_impl.h"
+
+namespace stx
+{
+
+namespace format_batch_impl
+{
+
+/* Smaller partitions are not worth a thread. */
+constexpr std::size_t min_rows_per_thread = 256u;
+
+inline std::size_t thread_count(std::size_t threads, std::size_t rows)
+{
+    if (threads == 0u)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    return std::clamp<std::size_t>(rows / min_rows_per_thread, 1u, threads);
+}
+
+/**
+ * Calls `f(i)` for i in [0, n), on n - 1 new threads and the calling one.
+ * Indices whose thread can not be started run on the calling thread.
+ *
+ * All threads are joined before the first exception thrown by `f` (in
+ * order of i) is rethrown on the calling thread.
+ */
+template <class _Fn>
+void parallel_for(std::size_t n, _Fn&& f)
+{
+    std::vector<std::exception_ptr> errors(n);
+    auto run = [&f, &errors](std::size_t i) {
+        try {
+            f(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+        workers.reserve(n > 0u ? n - 1u : 0u);
+        for (std::size_t i = 1u; i < n; ++i)
+            workers.emplace_back(run, i);
+    } catch (...) {
+        /* Out of threads or memory, keep the started ones. */
+    }
+
+    for (auto i = workers.size() + 1u; i < n; ++i)
+        run(i);
+    if (n > 0u)
+        run(0u);
+
+    for (auto& worker : workers)
+        worker.join();
+
+    for (const auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+/**
+ * Format `rows` into `threads` buffers of consecutive rows.
+ */
+template <class _Rows>
+std::vector<std::string> format_parts(const compiled_format& fmt, const _Rows& rows, std::size_t threads)
+{
+    const auto size = static_cast<std::size_t>(std::distance(std::begin(rows), std::end(rows)));
+    const auto parts = thread_count(threads, size);
+    const auto rows_per_part = (size + parts - 1u) / std::max<std::size_t>(parts, 1u);
+
+    std::vector<std::string> buffers(parts);
+    parallel_for(parts, [&](std::size_t part) {
+        const auto first = std::min(size, part * rows_per_part);
+        const auto last = std::min(size, first + rows_per_part);
+
+        auto iter = std::begin(rows);
+        std::advance(iter, first);
+
+        auto& buffer = buffers[part];
+        for (auto i = first; i < last; ++i, ++iter) {
+            std::apply([&](const auto& ...args) {
+                fmt.format_to(std::back_inserter(buffer), args...);
+            }, *iter);
+        }
+    });
+
+    return buffers;
+}
+
+/**
+ * Copy `buffers` to `out` back to back, in parallel.
+ */
+inline char* copy_parts(const std::vector<std::string>& buffers, char* out)
+{
+    std::vector<std::size_t> offsets(buffers.size() + 1u, 0u);
+    for (std::size_t i = 0u; i < buffers.size(); ++i)
+        offsets[i + 1u] = offsets[i] + buffers[i].size();
+
+    parallel_for(buffers.size(), [&](std::size_t i) {
+        if (!buffers[i].empty())
+            std::memcpy(out + offsets[i], buffers[i].data(), buffers[i].size());
+    });
+
+    return out + offsets.back();
+}
+
+}
+
+/**
+ * Format each row of range `rows` (tuples of arguments) using format
+ * string `fmt`, writing to `out` in order of the rows. Returns the
+ * iterator behind the last written char.
+ *
+ * The rows are partitioned over up to `threads` threads (0: one per
+ * hardware thread), each formatting into its own buffer. The buffers
+ * are then concatenated into `out`; in parallel, if `out` is a char
+ * pointer. Small batches are formatted on the calling thread.
+ *
+ * Output is identical to calling `format_to(out, fmt, args...)` for each
+ * row, except for fields referring to no argument, which throw
+ * std::invalid_argument (see `compiled_format`). Exceptions thrown by
+ * formatters are rethrown on the calling thread, before anything is
+ * written to `out`.
+ *
+ * Example:
+ *   std::vector<std::tuple<std::string, int>> rows = ...;
+ *   stx::format_batch_to(std::back_inserter(text), "{}: {}\n", rows);
+ */
+template <class _Iter, class _Rows>
+_Iter format_batch_to(_Iter out, std::string_view fmt, const _Rows& rows, std::size_t threads = 0u)
+{
+    const auto buffers = format_batch_impl::format_parts(compiled_format(fmt), rows, threads);
+
+    if constexpr (std::is_same_v<_Iter, char*>) {
+        return format_batch_impl::copy_parts(buffers, out);
+    } else {
+        for (const auto& buffer : buffers)
+            out = format_impl::write(out, buffer.data(), buffer.size());
+        return out;
+    }
+}
+
+/**
+ * See `format_batch_to`, using allocator `alloc` for the result of
+ * type `_String`.
+ *
+ * Example:
+ *   format_batch<std::pmr::string>(std::allocator_arg, &arena, fmt, rows)
+ */
+template <class _String, class _Rows>
+_String format_batch(std::allocator_arg_t,
+                     const typename _String::allocator_type& alloc,
+                     std::string_view fmt,
+                     const _Rows& rows,
+                     std::size_t threads = 0u)
+{
+    const auto buffers = format_batch_impl::format_parts(compiled_format(fmt), rows, threads);
+
+    std::size_t size = 0u;
+    for (const auto& buffer : buffers)
+        size += buffer.size();
+
+    /* Appended sequentially, sizing the result up front would zero it. */
+    _String result(alloc);
+    result.reserve(size);
+    for (const auto& buffer : buffers)
+        result.append(buffer.data(), buffer.size());
+    return result;
+}
+
+/**
+ * See `format_batch_to`.
+ */
+template <class _Rows>
+std::string format_batch(std::string_view fmt, const _Rows& rows, std::size_t threads = 0u)
+{
+    return format_batch<std::string>(std::allocator_arg, {}, fmt, rows, threads);
+}
+
+/**
+ * Format rows like `format_batch_to`, writing the per-thread buffers to
+ * file descriptor `fd` using writev (without concatenating them).
+ *
+ * Returns false on error.
+ */
+template <class _Rows>
+bool write_batch(int fd, std::string_view fmt, const _Rows& rows, std::size_t threads = 0u)
+{
+    const auto buffers = format_batch_impl::format_parts(compiled_format(fmt), rows, threads);
+
+    std::vector<io_impl::buffer> iov;
+    iov.reserve(buffers.size());
+    for (const auto& buffer : buffers)
+        iov.push_back({buffer.data(), buffer.size()});
+
+    return io_impl::write_all(fd, iov.data(), iov.size());
+}
+
+}
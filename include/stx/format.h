@@ -5,10 +5,12 @@
 #include <tuple>
 #include <cstring>
 #include <algorithm>
+#include <memory>
 
 #include "formatter.h"
 #include "format_impl.h"
 #include "format_charconv_impl.h"
+#include "fixed-string.h"
 
 namespace stx
 {
@@ -21,78 +23,13 @@ _Iter format_to(_Iter out, std::string_view fmt, const _Args& ...args)
 {
     std::tuple<const _Args&...> tuple(args...);
 
-    auto replace = [&tuple, next = 0u](auto begin, auto end, auto out) mutable {
-        std::size_t index = 0u;
-        std::string_view format;
-
-        if (begin == end)
-            return;
-
-        /* Parse optional argument index */
-        if (auto [iter, ok] = format_impl::parse_int(begin, end, index); ok) {
-            begin = iter;
-        } else {
-            index = next++; /* Auto incr. index */
-        }
-
-        /* Parse optional argument format */
-        if (begin != end && *begin == ':') {
-            if (++begin != end) {
-                const auto format_len = std::max<size_t>(std::distance(begin, end), 1) - 1; /* end is +1 off (behind the closing brace) */
-                format = std::string_view(&(*begin), static_cast<std::string_view::size_type>(format_len));
-            }
-        }
-
-        format_impl::format_value_at(index, tuple, format, out);
-    };
-
-    /* NOTE: Nested braces are not (yet?) allowed. */
-    auto skip_format = [](auto begin, auto end) {
-        while (begin != end) {
-            if (*begin == '}') {
-                if (++begin == end)
-                    return begin;
-
-                /* Escape double r-brace. */
-                if (*begin != '}')
-                    return begin;
-            }
-
-            ++begin;
-        }
-
-        return begin;
-    };
-
-    auto begin = fmt.cbegin();
-    auto end = fmt.cend();
-
-    while (begin != end) {
-        if (*begin == '{') {
-            if (++begin == end)
-                break;
-
-            /* Escape double l-brace. */
-            if (*begin == '{') {
-                *out = *begin++;
-            } else {
-                auto fmt_end = skip_format(begin, end);
-                replace(begin, fmt_end, out);
-
-                begin = fmt_end;
-            }
-        } else if (*begin == '}') {
-            if (++begin == end)
-                break;
-
-            /* Escape double r-brace. */
-            if (*begin == '}') {
-                *out++ = *begin++;
-            }
-        } else {
-            *out++ = *begin++;
-        }
-    }
+    format_impl::parse_format(fmt,
+        [&out](std::string_view text) {
+            out = format_impl::write(out, text.data(), text.size());
+        },
+        [&out, &tuple](std::size_t index, std::string_view spec) {
+            out = format_impl::format_value_at(index, tuple, spec, out);
+        });
 
     return out;
 }
@@ -121,12 +58,24 @@ _Iter format_to(_Iter out, std::string_view fmt, const _Args& ...args)
  *   The fill-char can be specified as first argument.
  *      format("{:0>5} {:_<6} {:.^3}", 123, "xx", 0) => "00123 xx____ .0."
  *
+ *   Strings can be padded by display width instead of byte size
+ *   by appending w (UTF-8 code points, wide characters count twice).
+ *   A lone w is the fill-char, use ww for fill-char w and the flag.
+ *      format("{:<5w}|", "äö") => "äö   |"
+ *      format("{:w}|", "äö") => "wäö|"
+ *
+ * Ranges, maps, tuples and optionals are supported, see `formatter.h`:
+ *   format("{}", std::vector{1, 2}) => "[1, 2]"
+ *
  * Nested {} as std::format supports them are not supported!
+ *
+ * The result type can be changed using `_String`, e.g.
+ * `format<std::pmr::string>("{}", 123)`.
  */
-template <class... _Args>
-std::string format(std::string_view fmt, const _Args& ...args)
+template <class _String = std::string, class... _Args>
+_String format(std::string_view fmt, const _Args& ...args)
 {
-    std::string out;
+    _String out;
     out.reserve(fmt.size());
 
     format_to(std::back_inserter(out), fmt, args...);
@@ -134,4 +83,90 @@ std::string format(std::string_view fmt, const _Args& ...args)
     return out;
 }
 
+/**
+ * See `format`.
+ *
+ * Allocator-aware version, the result uses allocator `alloc`.
+ *
+ * Example:
+ *   std::pmr::monotonic_buffer_resource arena;
+ *   format<std::pmr::string>(std::allocator_arg, &arena, "{}", 123) => "123"
+ */
+template <class _String = std::string, class... _Args>
+_String format(std::allocator_arg_t,
+               const typename _String::allocator_type& alloc,
+               std::string_view fmt,
+               const _Args& ...args)
+{
+    _String out(alloc);
+    out.reserve(fmt.size());
+
+    format_to(std::back_inserter(out), fmt, args...);
+
+    return out;
+}
+
+/**
+ * Returns the size of the output of `format(fmt, args...)`, without
+ * writing or allocating anything.
+ */
+template <class... _Args>
+std::size_t formatted_size(std::string_view fmt, const _Args& ...args)
+{
+    return format_to(format_impl::truncating_iterator<char*>(nullptr, 0u), fmt, args...).count;
+}
+
+/**
+ * Result of `format_to_n`.
+ */
+template <class _Iter>
+struct format_to_n_result
+{
+    _Iter out;        /* Iterator behind the last written character. */
+    std::size_t size; /* Untruncated size of the formatted output. */
+};
+
+/**
+ * See `format`.
+ *
+ * Writes at most `n` characters to `out`, the remaining output is
+ * truncated. The returned size is the size of the untruncated output,
+ * so `size > n` signals truncation.
+ *
+ * Example:
+ *   char buffer[8];
+ *   auto [out, size] = format_to_n(buffer, sizeof(buffer), "{}", "Hello, World!");
+ *   => buffer = "Hello, W", size = 13
+ *
+ * Does neither allocate, nor call locale dependent functions for the
+ * built-in formatters, and is therefore safe to use in signal handlers
+ * (floating point values excepted, if the standard library lacks
+ * floating point std::to_chars).
+ */
+template <class _Iter, class... _Args>
+format_to_n_result<_Iter> format_to_n(_Iter out, std::size_t n, std::string_view fmt, const _Args& ...args)
+{
+    auto iter = format_to(format_impl::truncating_iterator<_Iter>(out, n), fmt, args...);
+    return {iter.out, iter.count};
+}
+
+/**
+ * See `format`.
+ *
+ * Formats into a stack allocated `fixed_string` of capacity `_N`,
+ * truncating the output. See `format_to_n` for guarantees.
+ *
+ * Example:
+ *   format_fixed<16>("{}:{}", "localhost", 8080) => "localhost:8080"
+ */
+template <std::size_t _N, class... _Args>
+fixed_string<_N> format_fixed(std::string_view fmt, const _Args& ...args)
+{
+    fixed_string<_N> str;
+    const auto result = format_to_n(str.data(), _N, fmt, args...);
+    str.resize(result.size);
+
+    return str;
+}
+
 }
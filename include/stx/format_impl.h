@@ -3,49 +3,207 @@
 #include <string_view>
 #include <type_traits>
 #include <optional>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
 
 #include "formatter.h"
 #include "format_charconv_impl.h"
+#include "format_sink_impl.h"
+#include "simd_impl.h"
+#include "tuple-visit.h"
 
 namespace stx::format_impl
 {
 
 /**
  * Helper for calling formatter<T>::format on the n-the tuple element.
+ * Out of range indices write nothing.
  */
-template <size_t>
-struct format_value_at_t;
+template <class _Tuple, class _Iter>
+_Iter format_value_at(size_t index, const _Tuple& t, std::string_view fmt, _Iter out)
+{
+    if constexpr (std::tuple_size_v<_Tuple> == 0u) {
+        (void)index;
+        (void)t;
+        (void)fmt;
+        return out;
+    } else {
+        if (index >= std::tuple_size_v<_Tuple>)
+            return out;
+
+        return visit_at(index, t, [&](const auto& value) {
+            formatter<std::decay_t<decltype(value)>> vf(fmt);
+            return invoke_format(vf, value, out);
+        });
+    }
+}
 
-template <size_t _Index>
-struct format_value_at_t
+/**
+ * Returns a pointer to the first '{' or '}' in range `begin` to `end`,
+ * or `end`.
+ */
+inline const char* find_brace(const char* begin, const char* end)
 {
-    /* NOTE: _Index is 1based, Index0 is 0based */
-    static constexpr auto Index0 = _Index - 1u;
+#if defined(STX_SIMD_AVX2)
+    const auto lbrace32 = _mm256_set1_epi8('{');
+    const auto rbrace32 = _mm256_set1_epi8('}');
+    for (; end - begin >= 32; begin += 32) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lbrace32), _mm256_cmpeq_epi8(v, rbrace32))));
+        if (mask)
+            return begin + simd_impl::ctz(mask);
+    }
+#endif
+#if defined(STX_SIMD_SSE2)
+    const auto lbrace = _mm_set1_epi8('{');
+    const auto rbrace = _mm_set1_epi8('}');
+    for (; end - begin >= 16; begin += 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, lbrace), _mm_cmpeq_epi8(v, rbrace))));
+        if (mask)
+            return begin + simd_impl::ctz(mask);
+    }
+#elif defined(STX_SIMD_NEON)
+    const auto lbrace = vdupq_n_u8('{');
+    const auto rbrace = vdupq_n_u8('}');
+    for (; end - begin >= 16; begin += 16) {
+        const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(begin));
+        const auto eq = vorrq_u8(vceqq_u8(v, lbrace), vceqq_u8(v, rbrace));
+        /* Narrow to 4 bits per byte. */
+        const auto mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask)
+            return begin + simd_impl::ctz(mask) / 4u;
+    }
+#endif
 
-    template <class _Tuple, class _Iter>
-    static void format(size_t index, const _Tuple& t, std::string_view fmt, _Iter out)
-    {
-        if (index == Index0) {
-            formatter<std::decay_t<std::tuple_element_t<Index0, _Tuple>>> vf(fmt);
-            return vf.format(std::get<Index0>(t), out);
+    while (begin != end && *begin != '{' && *begin != '}')
+        ++begin;
+    return begin;
+}
+
+/**
+ * Format string parser, shared by `format_to` and `compiled_format`.
+ *
+ * Calls `literal(std::string_view)` for each run of literal text
+ * (escaped braces are passed as single char) and
+ * `field(std::size_t index, std::string_view spec)` for each
+ * replacement field, in order.
+ */
+template <class _Literal, class _Field>
+void parse_format(std::string_view fmt, _Literal&& literal, _Field&& field)
+{
+    /* NOTE: Nested braces are not (yet?) allowed. */
+    auto skip_format = [](const char* begin, const char* end) {
+        while (begin != end) {
+            if (*begin == '}') {
+                if (++begin == end)
+                    return begin;
+
+                /* Escape double r-brace. */
+                if (*begin != '}')
+                    return begin;
+            }
+
+            ++begin;
+        }
+
+        return begin;
+    };
+
+    auto parse_field = [&field, next = std::size_t(0u)](const char* begin, const char* end) mutable {
+        std::size_t index = 0u;
+        std::string_view spec;
+
+        /* Parse optional argument index */
+        if (auto [iter, ok] = parse_int(begin, end, index); ok) {
+            begin = iter;
+        } else {
+            index = next++; /* Auto incr. index */
+        }
+
+        /* Parse optional argument format */
+        if (begin != end && *begin == ':') {
+            if (++begin != end) {
+                const auto spec_len = std::max<std::ptrdiff_t>(end - begin, 1) - 1; /* end is +1 off (behind the closing brace) */
+                spec = std::string_view(begin, static_cast<std::string_view::size_type>(spec_len));
+            }
         }
 
-        return format_value_at_t<_Index - 1 /* 1based */>::format(index, t, fmt, out);
+        field(index, spec);
+    };
+
+    auto begin = fmt.data();
+    const auto end = begin + fmt.size();
+
+    while (begin != end) {
+        const auto run = find_brace(begin, end);
+
+        if (run != begin) {
+            literal(std::string_view(begin, static_cast<std::size_t>(run - begin)));
+            if ((begin = run) == end)
+                break;
+        }
+
+        if (*begin == '{') {
+            if (++begin == end)
+                break;
+
+            /* Escape double l-brace. */
+            if (*begin == '{') {
+                literal(std::string_view(begin++, 1u));
+            } else {
+                auto fmt_end = skip_format(begin, end);
+                parse_field(begin, fmt_end);
+
+                begin = fmt_end;
+            }
+        } else {
+            if (++begin == end)
+                break;
+
+            /* Escape double r-brace. */
+            if (*begin == '}')
+                literal(std::string_view(begin++, 1u));
+        }
     }
-};
+}
 
-template <>
-struct format_value_at_t<0u>
+/**
+ * Output iterator adapter writing at most `limit` characters to `out`,
+ * while counting all characters written to it.
+ */
+template <class _Iter>
+struct truncating_iterator
 {
-    template <class _Tuple, class _Iter>
-    static void format(size_t, const _Tuple&, std::string_view, _Iter)
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    _Iter out;
+    std::size_t limit = 0u;
+    std::size_t count = 0u;
+
+    truncating_iterator(_Iter out, std::size_t limit)
+        : out(out)
+        , limit(limit)
     {}
-};
 
-template <class _Tuple, class _Iter>
-void format_value_at(size_t index, const _Tuple& t, std::string_view fmt, _Iter out)
-{
-    format_value_at_t<std::tuple_size_v<_Tuple>>::format(index, t, fmt, out);
-}
+    truncating_iterator& operator=(char c)
+    {
+        if (count++ < limit)
+            *out++ = c;
+        return *this;
+    }
+
+    truncating_iterator& operator*() { return *this; }
+    truncating_iterator& operator++() { return *this; }
+    truncating_iterator& operator++(int) { return *this; }
+};
 
 }
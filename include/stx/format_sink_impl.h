@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace stx::format_impl
+{
+
+/**
+ * Access to the container of a std::back_insert_iterator.
+ *
+ * The (standard mandated) protected member `container` is reachable
+ * through a member pointer taken in a derived class.
+ */
+template <class _Container>
+struct back_insert_container : std::back_insert_iterator<_Container>
+{
+    static _Container& get(std::back_insert_iterator<_Container>& iter)
+    {
+        return *(iter.*&back_insert_container::container);
+    }
+};
+
+template <class, class = void>
+struct has_append : std::false_type {};
+
+template <class _Container>
+struct has_append<_Container, std::void_t<decltype(std::declval<_Container&>().append(std::declval<const char*>(), std::size_t{})),
+                                          decltype(std::declval<_Container&>().append(std::size_t{}, char{}))>>
+    : std::true_type {};
+
+/**
+ * Bulk sinks are output iterators supporting writing whole
+ * character ranges at once:
+ *   - char pointers
+ *   - back_insert_iterators of containers providing
+ *     `append(const char*, size_t)` and `append(size_t, char)`
+ *     (e.g. std::string)
+ */
+template <class>
+struct is_bulk_sink : std::false_type {};
+
+template <>
+struct is_bulk_sink<char*> : std::true_type {};
+
+template <class _Container>
+struct is_bulk_sink<std::back_insert_iterator<_Container>> : has_append<_Container> {};
+
+template <class _Iter>
+inline constexpr bool is_bulk_sink_v = is_bulk_sink<_Iter>::value;
+
+/**
+ * Write `size` chars from `data` to `out`.
+ */
+template <class _Iter>
+_Iter write(_Iter out, const char* data, std::size_t size)
+{
+    if constexpr (std::is_same_v<_Iter, char*>) {
+        if (size)
+            std::memcpy(out, data, size);
+        return out + size;
+    } else if constexpr (is_bulk_sink_v<_Iter>) {
+        back_insert_container<typename _Iter::container_type>::get(out).append(data, size);
+        return out;
+    } else {
+        return std::copy_n(data, size, out);
+    }
+}
+
+/**
+ * Write `size` times char `c` to `out`.
+ */
+template <class _Iter>
+_Iter fill(_Iter out, std::size_t size, char c)
+{
+    if constexpr (std::is_same_v<_Iter, char*>) {
+        if (size)
+            std::memset(out, c, size);
+        return out + size;
+    } else if constexpr (is_bulk_sink_v<_Iter>) {
+        if (size)
+            back_insert_container<typename _Iter::container_type>::get(out).append(size, c);
+        return out;
+    } else {
+        return std::fill_n(out, size, c);
+    }
+}
+
+/**
+ * Call `f.format(value, out)` and return the advanced iterator.
+ *
+ * Supports custom formatters returning void, which is only valid
+ * for iterators writing through a reference (e.g. std::back_insert_iterator).
+ */
+template <class _Formatter, class _Value, class _Iter>
+_Iter invoke_format(_Formatter& f, const _Value& value, _Iter out)
+{
+    if constexpr (std::is_void_v<decltype(f.format(value, out))>) {
+        f.format(value, out);
+        return out;
+    } else {
+        return f.format(value, out);
+    }
+}
+
+}
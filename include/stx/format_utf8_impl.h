@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <algorithm>
+#include <iterator>
+
+#include "simd_impl.h"
+
+namespace stx::format_impl
+{
+
+/**
+ * Returns true if all chars of `sv` are 7 bit ASCII.
+ */
+inline bool is_ascii(std::string_view sv)
+{
+    const auto* p = reinterpret_cast<const std::uint8_t*>(sv.data());
+    const auto n = sv.size();
+    std::size_t i = 0u;
+
+#if defined(STX_SIMD_SSE2)
+    for (; i + 16u <= n; i += 16u) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))))
+            return false;
+    }
+#elif defined(STX_SIMD_NEON)
+    for (; i + 16u <= n; i += 16u) {
+        if (vmaxvq_u8(vld1q_u8(p + i)) & 0x80u)
+            return false;
+    }
+#endif
+
+    for (; i < n; ++i) {
+        if (p[i] & 0x80u)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Number of UTF-8 code points in `sv` (number of non-continuation bytes).
+ */
+inline std::size_t count_code_points(std::string_view sv)
+{
+    const auto* p = reinterpret_cast<const std::uint8_t*>(sv.data());
+    const auto n = sv.size();
+    std::size_t i = 0u;
+    std::size_t count = 0u;
+
+    /* Continuation bytes (0x80-0xbf) are the only bytes <= -65 as int8. */
+#if defined(STX_SIMD_SSE2)
+    const auto threshold = _mm_set1_epi8(-65);
+    for (; i + 16u <= n; i += 16u) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        count += simd_impl::popcount(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, threshold))));
+    }
+#elif defined(STX_SIMD_NEON)
+    const auto threshold = vdupq_n_s8(-65);
+    for (; i + 16u <= n; i += 16u) {
+        const auto v = vreinterpretq_s8_u8(vld1q_u8(p + i));
+        count += vaddvq_u8(vshrq_n_u8(vcgtq_s8(v, threshold), 7));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        if ((p[i] & 0xc0u) != 0x80u)
+            ++count;
+    }
+
+    return count;
+}
+
+/**
+ * Returns true if code point `cp` is displayed using two columns
+ * (East Asian Wide/Fullwidth and emoji presentation blocks).
+ */
+inline bool is_wide_code_point(std::uint32_t cp)
+{
+    struct range { std::uint32_t first, last; };
+
+    /* Sorted, compact approximation of Unicode's EastAsianWidth W and F classes. */
+    static constexpr range wide[] = {
+        {0x1100, 0x115f},   /* Hangul Jamo */
+        {0x231a, 0x231b},
+        {0x2329, 0x232a},
+        {0x23e9, 0x23ec},
+        {0x23f0, 0x23f0},
+        {0x23f3, 0x23f3},
+        {0x25fd, 0x25fe},
+        {0x2614, 0x2615},
+        {0x2648, 0x2653},
+        {0x267f, 0x267f},
+        {0x2693, 0x2693},
+        {0x26a1, 0x26a1},
+        {0x26aa, 0x26ab},
+        {0x26bd, 0x26be},
+        {0x26c4, 0x26c5},
+        {0x26ce, 0x26ce},
+        {0x26d4, 0x26d4},
+        {0x26ea, 0x26ea},
+        {0x26f2, 0x26f3},
+        {0x26f5, 0x26f5},
+        {0x26fa, 0x26fa},
+        {0x26fd, 0x26fd},
+        {0x2705, 0x2705},
+        {0x270a, 0x270b},
+        {0x2728, 0x2728},
+        {0x274c, 0x274c},
+        {0x274e, 0x274e},
+        {0x2753, 0x2755},
+        {0x2757, 0x2757},
+        {0x2795, 0x2797},
+        {0x27b0, 0x27b0},
+        {0x27bf, 0x27bf},
+        {0x2b1b, 0x2b1c},
+        {0x2b50, 0x2b50},
+        {0x2b55, 0x2b55},
+        {0x2e80, 0x303e},   /* CJK Radicals ... CJK Symbols and Punctuation */
+        {0x3041, 0x33ff},   /* Hiragana ... CJK Compatibility */
+        {0x3400, 0x4dbf},   /* CJK Unified Ideographs Extension A */
+        {0x4e00, 0x9fff},   /* CJK Unified Ideographs */
+        {0xa000, 0xa4cf},   /* Yi */
+        {0xa960, 0xa97f},   /* Hangul Jamo Extended-A */
+        {0xac00, 0xd7a3},   /* Hangul Syllables */
+        {0xf900, 0xfaff},   /* CJK Compatibility Ideographs */
+        {0xfe10, 0xfe19},   /* Vertical Forms */
+        {0xfe30, 0xfe6f},   /* CJK Compatibility Forms, Small Form Variants */
+        {0xff00, 0xff60},   /* Fullwidth Forms */
+        {0xffe0, 0xffe6},
+        {0x16fe0, 0x16fe4},
+        {0x17000, 0x18aff}, /* Tangut */
+        {0x1b000, 0x1b2ff}, /* Kana Supplement ... Nushu */
+        {0x1f004, 0x1f004},
+        {0x1f0cf, 0x1f0cf},
+        {0x1f18e, 0x1f18e},
+        {0x1f191, 0x1f19a},
+        {0x1f200, 0x1f2ff}, /* Enclosed Ideographic Supplement */
+        {0x1f300, 0x1f64f}, /* Misc. Symbols and Pictographs, Emoticons */
+        {0x1f680, 0x1f6ff}, /* Transport and Map Symbols */
+        {0x1f7e0, 0x1f7eb},
+        {0x1f900, 0x1f9ff}, /* Supplemental Symbols and Pictographs */
+        {0x1fa70, 0x1faff}, /* Symbols and Pictographs Extended-A */
+        {0x20000, 0x2fffd}, /* CJK Unified Ideographs Extension B ... */
+        {0x30000, 0x3fffd}, /* CJK Unified Ideographs Extension G ... */
+    };
+
+    if (cp < wide[0].first)
+        return false;
+
+    auto iter = std::upper_bound(std::begin(wide), std::end(wide), cp, [](auto cp, const auto& r) {
+        return cp < r.first;
+    });
+
+    return iter != std::begin(wide) && cp <= std::prev(iter)->last;
+}
+
+/**
+ * Display width (terminal columns) of UTF-8 string `sv`.
+ *
+ * Counts code points, wide characters count twice. ASCII-only strings
+ * are detected first and return their size.
+ */
+inline std::size_t display_width(std::string_view sv)
+{
+    if (is_ascii(sv))
+        return sv.size();
+
+    auto width = count_code_points(sv);
+
+    /* Wide code points start at U+1100, encoded with 3 or 4 bytes (lead byte >= 0xe1). */
+    const auto* p = reinterpret_cast<const std::uint8_t*>(sv.data());
+    const auto n = sv.size();
+    for (std::size_t i = 0u; i < n; ++i) {
+        const auto lead = p[i];
+        if (lead < 0xe1u)
+            continue;
+
+        std::uint32_t cp = 0u;
+        if (lead < 0xf0u && i + 2u < n) {
+            cp = ((lead & 0x0fu) << 12) | ((p[i + 1u] & 0x3fu) << 6) | (p[i + 2u] & 0x3fu);
+            i += 2u;
+        } else if (lead < 0xf5u && i + 3u < n) {
+            cp = ((lead & 0x07u) << 18) | ((p[i + 1u] & 0x3fu) << 12) | ((p[i + 2u] & 0x3fu) << 6) | (p[i + 3u] & 0x3fu);
+            i += 3u;
+        }
+
+        if (is_wide_code_point(cp))
+            ++width;
+    }
+
+    return width;
+}
+
+}
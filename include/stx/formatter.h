@@ -6,9 +6,17 @@
 #include <algorithm>
 #include <type_traits>
 #include <array>
+#include <utility>
+#include <tuple>
+#include <cstddef>
+#include <iterator>
+#include <charconv>
+#include <cstdio>
 
 #include "string.h"
 #include "format_charconv_impl.h"
+#include "format_sink_impl.h"
+#include "format_utf8_impl.h"
 
 namespace stx
 {
@@ -62,7 +70,7 @@ struct formatter_base
      *
      * Parsing all generic/universal formatting options.
      * Child classes must call justify_pre and justify_post
-     * before and after writing their values.
+     * before and after writing their values, or use `write_padded`.
      */
     formatter_base(std::string_view& fmt)
     {
@@ -81,59 +89,99 @@ struct formatter_base
         /* {:[.]} */
         if (!fillc && !min_width)
             fillc = eat_char(fmt, {});
+
+        /* Without fill-char and width, justification is a no-op. */
+        padded = fillc || min_width;
     }
 
-    template <class _Iter>
-    void justify_pre(size_t width, _Iter out)
+    /**
+     * Returns the number of fill-chars to write before and after
+     * a value of width `width`.
+     */
+    std::pair<size_t, size_t> padding(size_t width) const
     {
 #if defined(__GNUC__) && !defined(__clang__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized" /* GCC warns about `min_width` being accessed unitialized, which is not the case. */
 #endif
-        if (justify == '>') {
-            if (min_width && width < min_width)
-                std::fill_n(out, *min_width - width, fillc.value_or(' '));
-        } else if (justify == '^') {
-            if (min_width && width < min_width)
-                std::fill_n(out, (*min_width - width) / 2, fillc.value_or(' '));
-        } else if (justify == '<') {
-            /* Special case: Prepend 1 fillc if value is non-empty.
+        if (!padded)
+            return {0u, 0u};
+
+        if (min_width) {
+            if (width >= *min_width)
+                return {0u, 0u};
+
+            const auto n = *min_width - width;
+            if (justify == '>')
+                return {n, 0u};
+            if (justify == '^')
+                return {n / 2, n / 2 + (n % 2)};
+            if (justify == '<')
+                return {0u, n};
+        } else if (width > 0) {
+            /* Special case: Prepend (or append) 1 fillc if value is non-empty.
              * Why? This supports a handy trick to prepend a space to non-empty values.
              * E.g. format("Hello{: }.", name) -> "Hello." or "Hello Johannes." */
-            if (!min_width && fillc && width > 0)
-                *out++ = *fillc;
+            if (justify == '<')
+                return {1u, 0u};
+            if (justify == '>')
+                return {0u, 1u};
         }
+
+        return {0u, 0u};
 #if defined(__GNUC__) && !defined(__clang__)
 #pragma GCC diagnostic pop
 #endif
     }
 
     template <class _Iter>
-    void justify_post(size_t width, _Iter out)
+    _Iter justify_pre(size_t width, _Iter out) const
     {
-#if defined(__GNUC__) && !defined(__clang__)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#endif
-        if (justify == '<') {
-            if (min_width && width < min_width)
-                std::fill_n(out, *min_width - width, fillc.value_or(' '));
-        } else if (justify == '^') {
-            if (min_width && width < min_width)
-                std::fill_n(out, (*min_width - width) / 2 + ((*min_width - width) % 2), fillc.value_or(' '));
-        } else if (justify == '>') {
-            /* See `justify_pre` comment. */
-            if (!min_width && fillc && width > 0)
-                *out++ = *fillc;
-        }
-#if defined(__GNUC__) && !defined(__clang__)
-#pragma GCC diagnostic pop
-#endif
+        return format_impl::fill(out, padding(width).first, fillc.value_or(' '));
+    }
+
+    template <class _Iter>
+    _Iter justify_post(size_t width, _Iter out) const
+    {
+        return format_impl::fill(out, padding(width).second, fillc.value_or(' '));
     }
+
+    /**
+     * Write `size` chars from `value` to `out`, justified according to
+     * the parsed options. Padding is computed once for both sides.
+     */
+    template <class _Iter>
+    _Iter write_padded(const char* value, size_t size, _Iter out) const
+    {
+        return write_padded(value, size, size, out);
+    }
+
+    /**
+     * See `write_padded`, using display width `width` instead of `size`
+     * for computing the padding.
+     */
+    template <class _Iter>
+    _Iter write_padded(const char* value, size_t size, size_t width, _Iter out) const
+    {
+        if (!padded)
+            return format_impl::write(out, value, size);
+
+        const auto [pre, post] = padding(width);
+        const auto c = fillc.value_or(' ');
+
+        out = format_impl::fill(out, pre, c);
+        out = format_impl::write(out, value, size);
+        return format_impl::fill(out, post, c);
+    }
+
+    bool padded = false;
 };
 
 /**
  * Type formatters.
+ *
+ * Formatters write their value to output iterator `out` and return
+ * the iterator behind the last written character.
  */
 template <class, class _Enable = void>
 struct formatter;
@@ -144,14 +192,12 @@ struct formatter<bool> : formatter_base
     using formatter_base::formatter_base;
 
     template <class _Iter>
-    void format(bool value, _Iter out)
+    _Iter format(bool value, _Iter out)
     {
         static const char* s[] = {"false", "true"};
         const auto size = value ? 4 : 5;
 
-        justify_pre(size, out);
-        std::copy_n(s[!!value], size, out);
-        justify_post(size, out);
+        return write_padded(s[!!value], size, out);
     }
 };
 
@@ -168,16 +214,20 @@ struct formatter<_Type, std::enable_if_t<std::is_floating_point_v<_Type>>> : for
     }
 
     template <class _Iter>
-    void format(_Type value, _Iter out)
+    _Iter format(_Type value, _Iter out)
     {
         char buffer[30];
         buffer[0] = '\0';
 
-        auto size = std::snprintf(buffer, sizeof(buffer), "%g",  value);
+#if defined(__cpp_lib_to_chars)
+        /* Same output as "%g", but locale independent and async-signal-safe. */
+        const auto size = static_cast<std::size_t>(
+            std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6).ptr - buffer);
+#else
+        const auto size = static_cast<std::size_t>(std::snprintf(buffer, sizeof(buffer), "%g", value));
+#endif
 
-        justify_pre(size, out);
-        std::copy_n(buffer, size, out);
-        justify_post(size, out);
+        return write_padded(buffer, size, out);
     }
 };
 
@@ -200,43 +250,15 @@ struct formatter<_Type, std::enable_if_t<std::is_integral_v<_Type>>> : formatter
     }
 
     template <class _Iter>
-    void format(_Type value, _Iter out)
+    _Iter format(_Type value, _Iter out)
     {
         using MaxType = std::conditional_t<std::is_signed_v<_Type>, std::intmax_t, std::uintmax_t>;
-        const MaxType maxValue = static_cast<MaxType>(value);
-        auto uabs = [](auto value) -> std::uintmax_t {
-            if constexpr (std::is_signed_v<_Type>)
-                return (std::uintmax_t)std::abs((std::intmax_t)value);
-            else
-                return (std::uintmax_t)value;
-        };
 
         char buffer[30];
-        buffer[0] = '\0';
-
-        std::size_t size = 0u;
-        switch (base) {
-        case 8:
-            size = std::snprintf(buffer, sizeof(buffer), "%s%jo",
-                                 maxValue < 0 ? "-" : "", uabs(maxValue));
-            break;
-        case 16:
-            size = std::snprintf(buffer, sizeof(buffer), "%s%jx",
-                                 maxValue < 0 ? "-" : "", uabs(maxValue));
-            break;
-        default:
-            if constexpr (std::is_signed_v<_Type>)
-                size = std::snprintf(buffer, sizeof(buffer), "%jd",
-                                     maxValue);
-            else
-                size = std::snprintf(buffer, sizeof(buffer), "%ju",
-                                     maxValue);
-            break;
-        }
+        const auto size = static_cast<std::size_t>(
+            std::to_chars(buffer, buffer + sizeof(buffer), static_cast<MaxType>(value), base).ptr - buffer);
 
-        justify_pre(size, out);
-        std::copy_n(buffer, size, out);
-        justify_post(size, out);
+        return write_padded(buffer, size, out);
     }
 };
 
@@ -244,19 +266,41 @@ template <class _Type>
 struct formatter<_Type, std::enable_if_t<std::is_same_v<_Type, std::string_view> ||
                                          std::is_same_v<_Type, std::string>>> : formatter_base
 {
+    /* Pad by display width (UTF-8 code points, wide chars count twice)
+     * instead of byte size. */
+    bool utf8_width = false;
+
     formatter(std::string_view& sv)
+        : formatter(sv, eat_width_flag(sv))
+    {}
+
+    /* {:...w}, the flag is stripped before the generic options are
+     * parsed. A lone `w` stays the fill-char (`{:w}`), without padding
+     * the flag would have no effect anyway. */
+    static bool eat_width_flag(std::string_view& sv)
+    {
+        if (sv.size() < 2u || sv.back() != 'w')
+            return false;
+
+        sv.remove_suffix(1u);
+        return true;
+    }
+
+    formatter(std::string_view& sv, bool w)
         : formatter_base(sv)
+        , utf8_width(w)
     {
         if (!justify)
             justify = '<';
     }
 
     template <class _Iter>
-    void format(const _Type& value, _Iter out)
+    _Iter format(const _Type& value, _Iter out)
     {
-        justify_pre(value.size(), out);
-        std::copy(value.begin(), value.end(), out);
-        justify_post(value.size(), out);
+        if (utf8_width && padded)
+            return write_padded(value.data(), value.size(), format_impl::display_width(value), out);
+
+        return write_padded(value.data(), value.size(), out);
     }
 };
 
@@ -266,12 +310,277 @@ struct formatter<const char*> : formatter<std::string_view>
     using formatter<std::string_view>::formatter;
 
     template <class _Iter>
-    void format(const char* value, _Iter out)
+    _Iter format(const char* value, _Iter out)
     {
+        /* Null strings format as empty strings. */
+        if (!value)
+            value = "";
+
+        /* Unpadded values to non-bulk sinks: Single pass, no strlen. */
+        if constexpr (!format_impl::is_bulk_sink_v<_Iter>) {
+            if (!padded) {
+                while (*value)
+                    *out++ = *value++;
+                return out;
+            }
+        }
+
         return formatter<std::string_view>::format(value, out);
     }
 };
 
+namespace format_impl
+{
+
+template <class _Type>
+inline constexpr bool is_string_like_v = std::is_convertible_v<const _Type&, std::string_view>
+#if defined(QT_CORE_LIB)
+                                         || std::is_same_v<_Type, QString>
+                                         || std::is_same_v<_Type, QUuid>
+#endif
+                                         ;
+
+template <class _Type, class = void>
+struct is_range : std::false_type {};
+
+template <class _Type>
+struct is_range<_Type, std::void_t<decltype(std::begin(std::declval<const _Type&>())),
+                                   decltype(std::end(std::declval<const _Type&>()))>>
+    : std::bool_constant<!is_string_like_v<_Type>> {};
+
+template <class _Type, class = void>
+struct is_map_like : std::false_type {};
+
+template <class _Type>
+struct is_map_like<_Type, std::void_t<typename _Type::key_type,
+                                      typename _Type::mapped_type>> : is_range<_Type> {};
+
+template <class _Range>
+using range_value_t = typename std::iterator_traits<decltype(std::begin(std::declval<const _Range&>()))>::value_type;
+
+/**
+ * Range, map and tuple format options.
+ *
+ * {:[n][s<separator>][:<element format>]}
+ *   n  Do not write brackets.
+ *   s  Use the following chars (up to the next ':') as separator.
+ *   :  Format all elements using the following format.
+ *
+ * Examples:
+ *   format("{}", std::vector{1, 2})       => "[1, 2]"
+ *   format("{:n:>3}", std::vector{1, 2})  => "  1,   2"
+ *   format("{:ns/}", std::vector{1, 2})   => "1/2"
+ *   format("{::0x}", std::vector{10, 11}) => "[a, b]"
+ */
+struct range_spec
+{
+    bool brackets = true;
+    std::string_view separator = ", ";
+    std::string_view element;
+
+    range_spec(std::string_view& sv, bool default_brackets = true, std::string_view default_separator = ", ")
+        : brackets(default_brackets)
+        , separator(default_separator)
+    {
+        if (!sv.empty() && sv.front() == 'n') {
+            brackets = false;
+            sv.remove_prefix(1u);
+        }
+
+        if (!sv.empty() && sv.front() == 's') {
+            sv.remove_prefix(1u);
+            separator = sv.substr(0u, sv.find(':'));
+            sv.remove_prefix(separator.size());
+        }
+
+        if (!sv.empty() && sv.front() == ':') {
+            element = sv.substr(1u);
+            sv = {};
+        }
+    }
+
+    template <class _Iter>
+    _Iter open(char c, _Iter out) const
+    {
+        if (brackets)
+            *out++ = c;
+        return out;
+    }
+
+    template <class _Iter>
+    _Iter close(char c, _Iter out) const
+    {
+        return open(c, out);
+    }
+
+    template <class _Type>
+    auto element_formatter() const
+    {
+        auto spec = element;
+        return formatter<std::remove_cv_t<_Type>>(spec);
+    }
+};
+
+}
+
+/**
+ * Single byte, as two hex digits. Use X for uppercase digits.
+ */
+template <>
+struct formatter<std::byte> : formatter_base
+{
+    bool upcase = false;
+
+    formatter(std::string_view& sv)
+        : formatter_base(sv)
+    {
+        if (!justify)
+            justify = '>';
+
+        upcase = formatter_base::eat_char(sv, "xX").value_or('x') == 'X';
+    }
+
+    template <class _Iter>
+    _Iter format(std::byte value, _Iter out)
+    {
+        const char* charset = upcase ? "0123456789ABCDEF" : "0123456789abcdef";
+        const auto byte = std::to_integer<unsigned>(value);
+        const char buffer[2] = {charset[byte >> 4], charset[byte & 0xfu]};
+
+        return write_padded(buffer, 2u, out);
+    }
+};
+
+/**
+ * Ranges, formatted as "[a, b, ...]".
+ *
+ * Ranges of std::byte are written without brackets and without separator
+ * by default, resulting in a hex string. See `format_impl::range_spec`
+ * for options.
+ */
+template <class _Type>
+struct formatter<_Type, std::enable_if_t<format_impl::is_range<_Type>::value &&
+                                         !format_impl::is_map_like<_Type>::value>> : format_impl::range_spec
+{
+    using element_type = format_impl::range_value_t<_Type>;
+
+    static constexpr bool is_bytes = std::is_same_v<std::remove_cv_t<element_type>, std::byte>;
+
+    formatter(std::string_view& sv)
+        : format_impl::range_spec(sv, !is_bytes, is_bytes ? "" : ", ")
+    {}
+
+    template <class _Iter>
+    _Iter format(const _Type& value, _Iter out)
+    {
+        auto f = element_formatter<element_type>();
+
+        out = open('[', out);
+        auto first = true;
+        for (const auto& element : value) {
+            if (!first)
+                out = format_impl::write(out, separator.data(), separator.size());
+            first = false;
+
+            out = format_impl::invoke_format(f, static_cast<const element_type&>(element), out);
+        }
+        return close(']', out);
+    }
+};
+
+/**
+ * Maps, formatted as "{k: v, ...}".
+ *
+ * The element format applies to keys and values.
+ */
+template <class _Type>
+struct formatter<_Type, std::enable_if_t<format_impl::is_map_like<_Type>::value>> : format_impl::range_spec
+{
+    using format_impl::range_spec::range_spec;
+
+    template <class _Iter>
+    _Iter format(const _Type& value, _Iter out)
+    {
+        auto kf = element_formatter<typename _Type::key_type>();
+        auto vf = element_formatter<typename _Type::mapped_type>();
+
+        out = open('{', out);
+        auto first = true;
+        for (const auto& [k, v] : value) {
+            if (!first)
+                out = format_impl::write(out, separator.data(), separator.size());
+            first = false;
+
+            out = format_impl::invoke_format(kf, k, out);
+            out = format_impl::write(out, ": ", 2u);
+            out = format_impl::invoke_format(vf, v, out);
+        }
+        return close('}', out);
+    }
+};
+
+/**
+ * Tuples and pairs, formatted as "(a, b, ...)".
+ *
+ * The element format applies to all elements.
+ */
+template <class... _Types>
+struct formatter<std::tuple<_Types...>> : format_impl::range_spec
+{
+    using format_impl::range_spec::range_spec;
+
+    template <class _Tuple, class _Iter>
+    _Iter format(const _Tuple& value, _Iter out)
+    {
+        out = open('(', out);
+        std::apply([&, first = true](const auto& ...elements) mutable {
+            auto format_element = [&](const auto& element) {
+                if (!first)
+                    out = format_impl::write(out, separator.data(), separator.size());
+                first = false;
+
+                auto f = element_formatter<std::decay_t<decltype(element)>>();
+                out = format_impl::invoke_format(f, element, out);
+            };
+            (void)format_element; /* Unused for empty tuples. */
+            (format_element(elements), ...);
+        }, value);
+        return close(')', out);
+    }
+};
+
+template <class _First, class _Second>
+struct formatter<std::pair<_First, _Second>> : formatter<std::tuple<_First, _Second>>
+{
+    using formatter<std::tuple<_First, _Second>>::formatter;
+};
+
+/**
+ * Optional values. Engaged values are formatted using the format
+ * of the value type, empty ones as "none".
+ */
+template <class _Type>
+struct formatter<std::optional<_Type>>
+{
+    std::string_view none_spec;
+    formatter<std::remove_cv_t<_Type>> value_formatter;
+
+    formatter(std::string_view& sv)
+        : none_spec(sv)
+        , value_formatter(sv)
+    {}
+
+    template <class _Iter>
+    _Iter format(const std::optional<_Type>& value, _Iter out)
+    {
+        if (value)
+            return format_impl::invoke_format(value_formatter, *value, out);
+
+        formatter<std::string_view> f(none_spec);
+        return f.format(std::string_view("none"), out);
+    }
+};
+
 #if defined(QT_CORE_LIB)
 template <class _Type>
 struct formatter<_Type, std::enable_if_t<std::is_same_v<_Type, QString> ||
@@ -280,7 +589,7 @@ struct formatter<_Type, std::enable_if_t<std::is_same_v<_Type, QString> ||
     using formatter<std::string_view>::formatter;
 
     template <class _Iter>
-    void format(const _Type& value, _Iter out)
+    _Iter format(const _Type& value, _Iter out)
     {
         return formatter<std::string_view>::format(stx::to_string(value), out);
     }
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "string.h"
+
+namespace stx
+{
+
+/**
+ * Thread-safe string interning pool.
+ *
+ * Deduplicates strings into arena-allocated chunks and returns
+ * `std::string_view`s (or 32 bit ids) that stay valid for the lifetime
+ * of the pool. Equal strings always yield the same view (same address)
+ * and id, so interned strings can be compared by pointer.
+ *
+ * The pool is sharded by hash; each shard is protected by a
+ * `std::shared_mutex`, lookups of known strings take a shared lock only.
+ *
+ * Each shard holds at most 2^(32 - log2(shards)) strings, interning
+ * more throws `std::length_error`.
+ *
+ * Example:
+ *   stx::intern_pool pool;
+ *   auto a = pool.intern(std::string("token"));
+ *   auto b = pool.intern("token");
+ *   a.data() == b.data() => true
+ */
+class intern_pool
+{
+public:
+    using id_type = std::uint32_t;
+
+    /**
+     * @param shards      Number of shards (rounded up to a power of two).
+     * @param chunk_size  Size of arena chunks in bytes; larger strings
+     *                    get a chunk of their own.
+     */
+    explicit intern_pool(std::size_t shards = 16u, std::size_t chunk_size = 64u * 1024u)
+        : chunk_size_(std::max<std::size_t>(chunk_size, 1u))
+    {
+        while ((std::size_t(1u) << shard_bits_) < shards && shard_bits_ < 8u)
+            ++shard_bits_;
+        shards_ = std::make_unique<shard[]>(std::size_t(1u) << shard_bits_);
+    }
+
+    intern_pool(const intern_pool&) = delete;
+    intern_pool& operator=(const intern_pool&) = delete;
+
+    /**
+     * Returns the interned copy of `s`.
+     */
+    std::string_view intern(std::string_view s)
+    {
+        return insert(s).first;
+    }
+
+    /**
+     * Returns the id of the interned copy of `s`.
+     */
+    id_type intern_id(std::string_view s)
+    {
+        return insert(s).second;
+    }
+
+    /**
+     * Returns the id of `s`, if interned.
+     */
+    std::optional<id_type> find(std::string_view s) const
+    {
+        const auto hash = std::hash<std::string_view>()(s);
+        const auto& sh = shards_[shard_index(hash)];
+
+        std::shared_lock lock(sh.mutex);
+        auto iter = sh.index.find(s);
+        if (iter == sh.index.end())
+            return {};
+        return iter->second;
+    }
+
+    /**
+     * Returns the interned string of id `id` (which must be valid).
+     */
+    std::string_view str(id_type id) const
+    {
+        const auto& sh = shards_[id & shard_mask()];
+
+        std::shared_lock lock(sh.mutex);
+        return sh.strings[id >> shard_bits_];
+    }
+
+    /**
+     * Number of interned strings.
+     */
+    std::size_t size() const
+    {
+        std::size_t n = 0u;
+        for (std::size_t i = 0u; i <= shard_mask(); ++i) {
+            std::shared_lock lock(shards_[i].mutex);
+            n += shards_[i].strings.size();
+        }
+        return n;
+    }
+
+    /**
+     * Number of bytes allocated for string storage.
+     */
+    std::size_t bytes() const
+    {
+        std::size_t n = 0u;
+        for (std::size_t i = 0u; i <= shard_mask(); ++i) {
+            std::shared_lock lock(shards_[i].mutex);
+            n += shards_[i].bytes;
+        }
+        return n;
+    }
+
+private:
+    struct alignas(64) shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string_view, id_type> index;
+        std::vector<std::string_view> strings; /* By local index */
+        std::vector<std::unique_ptr<char[]>> chunks;
+        char* pos = nullptr;
+        std::size_t left = 0u;
+        std::size_t bytes = 0u;
+    };
+
+    std::size_t shard_mask() const
+    {
+        return (std::size_t(1u) << shard_bits_) - 1u;
+    }
+
+    std::size_t shard_index(std::size_t hash) const
+    {
+        /* Upper bits; the lower ones select the hash table bucket. */
+        return (hash >> (sizeof(std::size_t) * 8u - 8u)) & shard_mask();
+    }
+
+    const char* store(shard& sh, std::string_view s)
+    {
+        if (s.size() > sh.left) {
+            const auto size = std::max(s.size(), chunk_size_);
+            /* Not value-initialized, strings are copied in right away. */
+            sh.chunks.push_back(std::unique_ptr<char[]>(new char[size]));
+            sh.bytes += size;
+
+            /* Keep the rest of the current chunk for small strings. */
+            if (size - s.size() < sh.left) {
+                std::memcpy(sh.chunks.back().get(), s.data(), s.size());
+                return sh.chunks.back().get();
+            }
+
+            sh.pos = sh.chunks.back().get();
+            sh.left = size;
+        }
+
+        auto* p = sh.pos;
+        std::memcpy(p, s.data(), s.size());
+        sh.pos += s.size();
+        sh.left -= s.size();
+        return p;
+    }
+
+    std::pair<std::string_view, id_type> insert(std::string_view s)
+    {
+        const auto hash = std::hash<std::string_view>()(s);
+        const auto index = shard_index(hash);
+        auto& sh = shards_[index];
+
+        {
+            std::shared_lock lock(sh.mutex);
+            auto iter = sh.index.find(s);
+            if (iter != sh.index.end())
+                return {iter->first, iter->second};
+        }
+
+        std::unique_lock lock(sh.mutex);
+        auto iter = sh.index.find(s);
+        if (iter != sh.index.end())
+            return {iter->first, iter->second};
+
+        /* Ids hold the shard index in their low `shard_bits_` bits. */
+        if (sh.strings.size() >> (32u - shard_bits_))
+            throw std::length_error("stx::intern_pool: shard is full");
+
+        const std::string_view copy(s.empty() ? "" : store(sh, s), s.size());
+        const auto id = static_cast<id_type>((sh.strings.size() << shard_bits_) | index);
+        sh.strings.push_back(copy);
+        sh.index.emplace(copy, id);
+        return {copy, id};
+    }
+
+    std::size_t chunk_size_;
+    unsigned shard_bits_ = 0u;
+    std::unique_ptr<shard[]> shards_;
+};
+
+/**
+ * Split string `what` at `at`, interning all parts into `pool`.
+ * See `split`.
+ *
+ * The parts stay valid as long as `pool` lives, `what` may be
+ * discarded.
+ */
+template <class _Container = std::vector<std::string_view>>
+_Container split_interned(intern_pool& pool,
+                          std::string_view what,
+                          std::string_view at,
+                          bool removeEmpty = true,
+                          const typename _Container::allocator_type& alloc = {})
+{
+    _Container container(alloc);
+
+    impl::split_each(what, at, removeEmpty, [&](std::string_view part) {
+        if constexpr (std::is_same_v<typename _Container::value_type, intern_pool::id_type>) {
+            container.push_back(pool.intern_id(part));
+        } else {
+            container.emplace_back(pool.intern(part));
+        }
+    });
+
+    return container;
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace stx::io_impl
+{
+
+/**
+ * Contiguous chunk of chars to write.
+ */
+struct buffer
+{
+    const char* data;
+    std::size_t size;
+};
+
+/**
+ * Write all `count` buffers to file descriptor `fd` (using writev,
+ * if available). Handles partial writes and interrupts.
+ *
+ * Returns false on error.
+ */
+inline bool write_all(int fd, const buffer* buffers, std::size_t count)
+{
+#if defined(_WIN32)
+    for (std::size_t i = 0u; i < count; ++i) {
+        auto data = buffers[i].data;
+        auto size = buffers[i].size;
+        while (size > 0u) {
+            const auto chunk = static_cast<unsigned>(std::min<std::size_t>(size, 1u << 30));
+            const auto n = ::_write(fd, data, chunk);
+            if (n < 0)
+                return false;
+
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    }
+    return true;
+#else
+#if defined(IOV_MAX)
+    constexpr std::size_t max_iov = std::min<std::size_t>(IOV_MAX, 64u);
+#else
+    constexpr std::size_t max_iov = 16u;
+#endif
+
+    iovec iov[max_iov];
+    while (count > 0u) {
+        const auto n = std::min(count, max_iov);
+        for (std::size_t i = 0u; i < n; ++i) {
+            iov[i].iov_base = const_cast<char*>(buffers[i].data);
+            iov[i].iov_len = buffers[i].size;
+        }
+
+        auto* first = iov;
+        auto remaining = n;
+        while (remaining > 0u) {
+            const auto written = ::writev(fd, first, static_cast<int>(remaining));
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+
+            /* Skip fully written buffers, adjust partially written one. */
+            auto left = static_cast<std::size_t>(written);
+            while (remaining > 0u && left >= first->iov_len) {
+                left -= first->iov_len;
+                ++first;
+                --remaining;
+            }
+            if (remaining > 0u) {
+                first->iov_base = static_cast<char*>(first->iov_base) + left;
+                first->iov_len -= left;
+            }
+        }
+
+        buffers += n;
+        count -= n;
+    }
+    return true;
+#endif
+}
+
+}
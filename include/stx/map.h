@@ -3,7 +3,12 @@
 #include <map>
 #include <unordered_map>
 
+#include <cstddef>
+#include <iterator>
 #include <type_traits>
+#include <utility>
+
+#include "simd_impl.h"
 
 namespace stx
 {
@@ -42,4 +47,141 @@ auto value_or(const _C<_KeyType, _ValueType, _Args...>& c,
     return std::forward<_FallbackType>(v);
 }
 
+namespace map_impl
+{
+
+/**
+ * Hashed lookups for `value_or_batch`: `probe` (the hash, or the bucket
+ * derived from it) is computed once per key, `prefetch` and `find` take
+ * it instead of hashing again.
+ */
+template <class _Map, class = void>
+struct hashed_lookup
+{
+    static constexpr bool enabled = false;
+};
+
+/* Maps providing `hash_key`, `prefetch_hashed` and `find_hashed`
+ * (e.g. `static_map`). */
+template <class _Map>
+struct hashed_lookup<_Map, std::void_t<
+    decltype(std::declval<const _Map&>().prefetch_hashed(_Map::hash_key(std::declval<const typename _Map::key_type&>()))),
+    decltype(std::declval<const _Map&>().find_hashed(std::declval<const typename _Map::key_type&>(),
+                                                     _Map::hash_key(std::declval<const typename _Map::key_type&>())))>>
+{
+    static constexpr bool enabled = true;
+
+    using key_type = typename _Map::key_type;
+    using probe_type = decltype(_Map::hash_key(std::declval<const key_type&>()));
+
+    static probe_type probe(const _Map&, const key_type& key)
+    {
+        return _Map::hash_key(key);
+    }
+
+    static void prefetch(const _Map& map, probe_type h)
+    {
+        map.prefetch_hashed(h);
+    }
+
+    static auto find(const _Map& map, const key_type& key, probe_type h)
+    {
+        return map.find_hashed(key, h);
+    }
+};
+
+/* std::unordered_map, through its bucket interface. The probe is the
+ * bucket index (`bucket(key)`, hashing the key once).
+ *
+ * The bucket array itself is not accessible, so `prefetch` resolves the
+ * bucket's first node (loading the bucket slot) and prefetches it. */
+template <class _Key, class _Value, class _Hash, class _Equal, class _Alloc>
+struct hashed_lookup<std::unordered_map<_Key, _Value, _Hash, _Equal, _Alloc>>
+{
+    static constexpr bool enabled = true;
+
+    using map_type = std::unordered_map<_Key, _Value, _Hash, _Equal, _Alloc>;
+    using key_type = _Key;
+    using probe_type = std::size_t;
+
+    static probe_type probe(const map_type& map, const key_type& key)
+    {
+        return map.bucket(key);
+    }
+
+    static void prefetch(const map_type& map, probe_type bucket)
+    {
+        const auto iter = map.begin(bucket);
+        if (iter != map.end(bucket))
+            simd_impl::prefetch(&*iter);
+    }
+
+    static const _Value* find(const map_type& map, const key_type& key, probe_type bucket)
+    {
+        const auto& eq = map.key_eq();
+        for (auto iter = map.begin(bucket); iter != map.end(bucket); ++iter) {
+            if (eq(iter->first, key))
+                return &iter->second;
+        }
+        return nullptr;
+    }
+};
+
+}
+
+/**
+ * Writes `value_or(map, key, fallback)` for each key of range `keys` to
+ * output iterator `out`. Returns the iterator behind the last written
+ * value.
+ *
+ * For hash maps (`std::unordered_map`, `static_map`) the lookups are
+ * pipelined: the keys are hashed once, 16 keys ahead, and their buckets
+ * prefetched while the current key is probed, hiding cache misses on
+ * large tables. Other maps fall back to plain lookups.
+ *
+ * Example:
+ *   std::vector<int> ids(keys.size());
+ *   stx::value_or_batch(table, keys, -1, ids.begin());
+ */
+template <class _Map, class _Keys, class _FallbackType, class _Out>
+_Out value_or_batch(const _Map& map, const _Keys& keys, const _FallbackType& fallback, _Out out)
+{
+    using Key = typename _Map::key_type;
+    using Lookup = map_impl::hashed_lookup<_Map>;
+
+    /* Convert once; value_or may return a reference to it. */
+    const typename _Map::mapped_type& fallback_value = fallback;
+
+    auto first = std::begin(keys);
+    const auto last = std::end(keys);
+
+    if constexpr (Lookup::enabled) {
+        constexpr std::size_t distance = 16u;
+        typename Lookup::probe_type probes[distance]; /* Of the next `distance` keys */
+
+        auto ahead = first;
+        for (std::size_t i = 0u; i < distance && ahead != last; ++i, ++ahead) {
+            probes[i] = Lookup::probe(map, static_cast<const Key&>(*ahead));
+            Lookup::prefetch(map, probes[i]);
+        }
+
+        for (std::size_t i = 0u; first != last; ++first, i = (i + 1u) % distance) {
+            const auto probe = probes[i];
+            if (ahead != last) {
+                probes[i] = Lookup::probe(map, static_cast<const Key&>(*ahead));
+                Lookup::prefetch(map, probes[i]);
+                ++ahead;
+            }
+
+            const auto* value = Lookup::find(map, static_cast<const Key&>(*first), probe);
+            *out++ = value ? *value : fallback_value;
+        }
+    } else {
+        for (; first != last; ++first)
+            *out++ = value_or(map, static_cast<const Key&>(*first), fallback_value);
+    }
+
+    return out;
+}
+
 }
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * SIMD instruction set detection.
+ *
+ * Defines STX_SIMD_SSE2, STX_SIMD_SSSE3, STX_SIMD_AVX2 and STX_SIMD_NEON
+ * (AArch64 only) depending on the compiler's target. All code paths using
+ * them must provide a scalar fallback. Define STX_NO_SIMD to force the
+ * scalar paths.
+ */
+#if !defined(STX_NO_SIMD)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define STX_SIMD_SSE2 1
+#    include <emmintrin.h>
+#  endif
+#  if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#    define STX_SIMD_SSSE3 1
+#    include <tmmintrin.h>
+#  endif
+#  if defined(__AVX2__)
+#    define STX_SIMD_AVX2 1
+#    include <immintrin.h>
+#  endif
+#  if defined(__aarch64__) || defined(_M_ARM64)
+#    define STX_SIMD_NEON 1
+#    include <arm_neon.h>
+#  endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace stx::simd_impl
+{
+
+/**
+ * Number of trailing zero bits of non-zero `v`.
+ */
+inline unsigned ctz(std::uint64_t v)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+#  if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanForward64(&index, v);
+#  else
+    if (!_BitScanForward(&index, static_cast<unsigned long>(v))) {
+        _BitScanForward(&index, static_cast<unsigned long>(v >> 32));
+        index += 32;
+    }
+#  endif
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(v));
+#endif
+}
+
+/**
+ * Number of set bits in `v`.
+ */
+inline unsigned popcount(std::uint64_t v)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<unsigned>((v * 0x0101010101010101ull) >> 56);
+#else
+    return static_cast<unsigned>(__builtin_popcountll(v));
+#endif
+}
+
+/**
+ * Hint the CPU to fetch the cache line of `p` (which need not be a valid
+ * address).
+ */
+inline void prefetch(const void* p)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+#  if defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#  else
+    (void)p;
+#  endif
+#else
+    __builtin_prefetch(p);
+#endif
+}
+
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "simd_impl.h"
+
+namespace stx
+{
+
+namespace static_map_impl
+{
+
+/* Not constexpr: reaching it during constant evaluation is a compile error. */
+inline void error_duplicate_key()
+{
+    std::abort();
+}
+
+constexpr std::uint64_t mix(std::uint64_t h)
+{
+    h ^= h >> 33u;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33u;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33u;
+    return h;
+}
+
+/* FNV-1a */
+constexpr std::uint64_t hash(std::string_view s)
+{
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (auto c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+template <class _T, class = std::enable_if_t<std::is_integral_v<_T> || std::is_enum_v<_T>>>
+constexpr std::uint64_t hash(_T v)
+{
+    return mix(static_cast<std::uint64_t>(v));
+}
+
+constexpr std::uint64_t slot_hash(std::uint64_t h, std::uint32_t seed)
+{
+    return mix(h ^ (seed * 0x9e3779b97f4a7c15ull));
+}
+
+constexpr std::size_t table_size(std::size_t n)
+{
+    std::size_t size = 1u;
+    while (size < 2u * n)
+        size <<= 1u;
+    return size;
+}
+
+}
+
+/**
+ * Immutable hash map built at compile time.
+ *
+ * Uses a perfect hash (hash and displace): keys are grouped into buckets
+ * by hash and each bucket gets a seed which maps all of its keys to
+ * distinct free slots. A lookup hashes the key once and does a single
+ * key comparison. Keys can be integers, enums or `std::string_view`.
+ *
+ * Construct using `make_static_map`. Duplicate keys are a compile error
+ * (or abort, if constructed at runtime).
+ *
+ * Example:
+ *   constexpr auto codes = stx::make_static_map<std::string_view, int>({
+ *       {"ok", 200},
+ *       {"not found", 404},
+ *   });
+ *   static_assert(stx::value_or(codes, "ok", 0) == 200);
+ */
+template <class _Key, class _Value, std::size_t _N>
+class static_map
+{
+public:
+    using key_type = _Key;
+    using mapped_type = _Value;
+    using value_type = std::pair<_Key, _Value>;
+    using const_iterator = const value_type*;
+
+    template <std::size_t... _I>
+    constexpr static_map(const value_type (&items)[_N], std::index_sequence<_I...>)
+        : entries_{{items[_I]...}}
+    {
+        build();
+    }
+
+    /**
+     * Returns a pointer to the value of `key`, or nullptr.
+     */
+    constexpr const _Value* find(const _Key& key) const
+    {
+        return find_hashed(key, hash_key(key));
+    }
+
+    /**
+     * Hashed lookup, used by `value_or_batch` to hash each key once:
+     * `find_hashed(key, hash_key(key))` equals `find(key)`.
+     */
+    static constexpr std::uint64_t hash_key(const _Key& key)
+    {
+        return static_map_impl::hash(key);
+    }
+
+    constexpr const _Value* find_hashed(const _Key& key, std::uint64_t h) const
+    {
+        const auto slot = slots_[slot_index(h)];
+        if (slot != 0u && entries_[slot - 1u].first == key)
+            return &entries_[slot - 1u].second;
+        return nullptr;
+    }
+
+    /**
+     * Prefetch the slot of hash `h` (see `hash_key`).
+     */
+    void prefetch_hashed(std::uint64_t h) const
+    {
+        simd_impl::prefetch(&slots_[slot_index(h)]);
+    }
+
+    constexpr bool contains(const _Key& key) const
+    {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * Returns the value of `key`, or `fallback`. See `stx::value_or`.
+     */
+    template <class _FallbackType>
+    constexpr _Value value_or(const _Key& key, _FallbackType&& fallback) const
+    {
+        const auto* v = find(key);
+        return v ? *v : static_cast<_Value>(std::forward<_FallbackType>(fallback));
+    }
+
+    /**
+     * Entries, in construction order.
+     */
+    constexpr const_iterator begin() const
+    {
+        return entries_.data();
+    }
+
+    constexpr const_iterator end() const
+    {
+        return entries_.data() + _N;
+    }
+
+    constexpr std::size_t size() const
+    {
+        return _N;
+    }
+
+    constexpr bool empty() const
+    {
+        return _N == 0u;
+    }
+
+private:
+    constexpr std::size_t slot_index(std::uint64_t h) const
+    {
+        return static_map_impl::slot_hash(h, seeds_[h % buckets]) & (slot_count - 1u);
+    }
+
+    static constexpr std::size_t buckets = _N > 0u ? _N : 1u;
+    static constexpr std::size_t slot_count = static_map_impl::table_size(_N);
+
+    constexpr void build()
+    {
+        /* Sort entry indices by bucket (counting sort). */
+        std::array<std::uint64_t, buckets> hashes{};
+        std::array<std::size_t, buckets + 1u> offsets{};
+        std::array<std::size_t, buckets> order{};
+
+        for (std::size_t i = 0u; i < _N; ++i) {
+            hashes[i] = static_map_impl::hash(entries_[i].first);
+            ++offsets[hashes[i] % buckets + 1u];
+        }
+        for (std::size_t b = 0u; b < buckets; ++b)
+            offsets[b + 1u] += offsets[b];
+
+        std::array<std::size_t, buckets> fill{};
+        for (std::size_t i = 0u; i < _N; ++i) {
+            const auto b = hashes[i] % buckets;
+            order[offsets[b] + fill[b]++] = i;
+        }
+
+        /* Place the largest buckets first. */
+        std::array<std::size_t, buckets> by_size{};
+        for (std::size_t b = 0u; b < buckets; ++b) {
+            auto j = b;
+            for (; j > 0u && fill[by_size[j - 1u]] < fill[b]; --j)
+                by_size[j] = by_size[j - 1u];
+            by_size[j] = b;
+        }
+
+        for (std::size_t k = 0u; k < buckets; ++k) {
+            const auto b = by_size[k];
+            const auto first = offsets[b];
+            const auto last = offsets[b + 1u];
+            if (first == last)
+                break;
+
+            for (auto i = first; i < last; ++i)
+                for (auto j = first; j < i; ++j)
+                    if (entries_[order[i]].first == entries_[order[j]].first)
+                        static_map_impl::error_duplicate_key();
+
+            for (std::uint32_t seed = 0u;; ++seed) {
+                auto i = first;
+                for (; i < last; ++i) {
+                    const auto slot = static_map_impl::slot_hash(hashes[order[i]], seed) & (slot_count - 1u);
+                    if (slots_[slot] != 0u)
+                        break;
+                    slots_[slot] = static_cast<std::uint32_t>(order[i] + 1u);
+                }
+
+                if (i == last) {
+                    seeds_[b] = seed;
+                    break;
+                }
+
+                /* Roll back */
+                while (i-- > first)
+                    slots_[static_map_impl::slot_hash(hashes[order[i]], seed) & (slot_count - 1u)] = 0u;
+            }
+        }
+    }
+
+    std::array<value_type, _N> entries_;
+    std::array<std::uint32_t, buckets> seeds_{};
+    std::array<std::uint32_t, slot_count> slots_{}; /* Entry index + 1 */
+};
+
+/**
+ * Create a `static_map` from a list of key-value pairs.
+ */
+template <class _Key, class _Value, std::size_t _N>
+constexpr static_map<_Key, _Value, _N> make_static_map(const std::pair<_Key, _Value> (&items)[_N])
+{
+    return static_map<_Key, _Value, _N>(items, std::make_index_sequence<_N>());
+}
+
+/**
+ * Returns the value for key `k`, or fallback value `v` if no value for
+ * the key could be found. See `value_or` in `map.h`.
+ */
+template <class _Key, class _Value, std::size_t _N, class _FallbackType>
+constexpr std::conditional_t<std::is_lvalue_reference_v<_FallbackType>, const _Value&, _Value>
+value_or(const static_map<_Key, _Value, _N>& c,
+         const typename static_map<_Key, _Value, _N>::key_type& k,
+         _FallbackType&& v)
+{
+    const auto* value = c.find(k);
+    if (value)
+        return *value;
+    return std::forward<_FallbackType>(v);
+}
+
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "io_impl.h"
+
+namespace stx
+{
+
+/**
+ * Append-only string stored in fixed-size chunks.
+ *
+ * Appending never moves already written data (no reallocation copies),
+ * so building very large outputs needs no more than the output size
+ * (rounded up to the chunk size) of memory. The content can be written
+ * to a file descriptor chunk by chunk or materialized once; `flush_to`
+ * writes and releases finished chunks while building.
+ *
+ * `std::back_inserter(builder)` is a bulk sink for `format_to` and
+ * `join_to`.
+ *
+ * Example:
+ *   stx::string_builder b;
+ *   stx::format_to(std::back_inserter(b), "{}: {}\n", key, value);
+ *   stx::join_to(std::back_inserter(b), lines.begin(), lines.end(), "\n");
+ *   b.write_to(STDOUT_FILENO);
+ */
+class string_builder
+{
+public:
+    using value_type = char;
+    using size_type = std::size_t;
+
+    explicit string_builder(std::size_t chunk_size = 64u * 1024u)
+        : chunk_size_(std::max<std::size_t>(chunk_size, 1u))
+    {}
+
+    /* The moved-from builder is empty and must not keep writing to
+     * the chunk it gave away. */
+    string_builder(string_builder&& other) noexcept
+        : chunk_size_(other.chunk_size_)
+        , chunks_(std::move(other.chunks_))
+        , pos_(std::exchange(other.pos_, nullptr))
+        , left_(std::exchange(other.left_, 0u))
+        , size_(std::exchange(other.size_, 0u))
+    {
+        other.chunks_.clear();
+    }
+
+    string_builder& operator=(string_builder&& other) noexcept
+    {
+        if (this != &other) {
+            chunk_size_ = other.chunk_size_;
+            chunks_ = std::move(other.chunks_);
+            pos_ = std::exchange(other.pos_, nullptr);
+            left_ = std::exchange(other.left_, 0u);
+            size_ = std::exchange(other.size_, 0u);
+            other.chunks_.clear();
+        }
+        return *this;
+    }
+
+    void push_back(char c)
+    {
+        if (left_ == 0u)
+            grow();
+
+        *pos_++ = c;
+        --left_;
+        ++size_;
+    }
+
+    string_builder& append(const char* data, std::size_t size)
+    {
+        while (size > 0u) {
+            if (left_ == 0u)
+                grow();
+
+            const auto n = std::min(size, left_);
+            std::memcpy(pos_, data, n);
+            advance(n);
+            data += n;
+            size -= n;
+        }
+        return *this;
+    }
+
+    string_builder& append(std::size_t count, char c)
+    {
+        while (count > 0u) {
+            if (left_ == 0u)
+                grow();
+
+            const auto n = std::min(count, left_);
+            std::memset(pos_, c, n);
+            advance(n);
+            count -= n;
+        }
+        return *this;
+    }
+
+    string_builder& append(std::string_view s)
+    {
+        return append(s.data(), s.size());
+    }
+
+    string_builder& operator+=(std::string_view s)
+    {
+        return append(s);
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0u;
+    }
+
+    /**
+     * Remove all content, keeping the first chunk.
+     */
+    void clear()
+    {
+        if (!chunks_.empty())
+            chunks_.resize(1u);
+
+        pos_ = chunks_.empty() ? nullptr : chunks_.front().get();
+        left_ = chunks_.empty() ? 0u : chunk_size_;
+        size_ = 0u;
+    }
+
+    /**
+     * Calls `f(std::string_view)` for each non-empty chunk, in order.
+     */
+    template <class _Fn>
+    void for_each_chunk(_Fn&& f) const
+    {
+        auto remaining = size_;
+        for (const auto& chunk : chunks_) {
+            const auto n = std::min(remaining, chunk_size_);
+            if (n == 0u)
+                break;
+
+            f(std::string_view(chunk.get(), n));
+            remaining -= n;
+        }
+    }
+
+    /**
+     * Returns the content as contiguous string.
+     *
+     * The result type can be changed using `_String`, e.g.
+     * `str<std::pmr::string>(&arena)`.
+     */
+    template <class _String = std::string>
+    _String str(const typename _String::allocator_type& alloc = {}) const
+    {
+        _String result(alloc);
+        result.reserve(size_);
+        for_each_chunk([&result](std::string_view chunk) {
+            result.append(chunk.data(), chunk.size());
+        });
+        return result;
+    }
+
+    /**
+     * Write the content to file descriptor `fd`, using writev.
+     *
+     * Returns false on error.
+     */
+    bool write_to(int fd) const
+    {
+        io_impl::buffer batch[64];
+        std::size_t count = 0u;
+        bool ok = true;
+
+        for_each_chunk([&](std::string_view chunk) {
+            if (count == std::size(batch)) {
+                ok = ok && io_impl::write_all(fd, batch, count);
+                count = 0u;
+            }
+            batch[count++] = {chunk.data(), chunk.size()};
+        });
+
+        return ok && io_impl::write_all(fd, batch, count);
+    }
+
+    /**
+     * Write the finished chunks to file descriptor `fd` and release
+     * them, keeping the chunk being written (or reusing the last one,
+     * if it is full). Calling this while building keeps the memory
+     * used at about one chunk.
+     *
+     * Returns false on error; the finished chunks are released anyway.
+     */
+    bool flush_to(int fd)
+    {
+        if (chunks_.empty())
+            return true;
+
+        const auto full = left_ == 0u ? chunks_.size() : chunks_.size() - 1u;
+
+        io_impl::buffer batch[64];
+        std::size_t count = 0u;
+        bool ok = true;
+
+        for (std::size_t i = 0u; i < full; ++i) {
+            if (count == std::size(batch)) {
+                ok = ok && io_impl::write_all(fd, batch, count);
+                count = 0u;
+            }
+            batch[count++] = {chunks_[i].get(), chunk_size_};
+        }
+        ok = ok && io_impl::write_all(fd, batch, count);
+
+        std::swap(chunks_.front(), chunks_.back());
+        chunks_.resize(1u);
+        if (left_ == 0u) {
+            pos_ = chunks_.front().get();
+            left_ = chunk_size_;
+        }
+        size_ -= full * chunk_size_;
+        return ok;
+    }
+
+private:
+    void grow()
+    {
+        /* Not value-initialized, chunks are written before being read. */
+        chunks_.push_back(std::unique_ptr<char[]>(new char[chunk_size_]));
+        pos_ = chunks_.back().get();
+        left_ = chunk_size_;
+    }
+
+    void advance(std::size_t n)
+    {
+        pos_ += n;
+        left_ -= n;
+        size_ += n;
+    }
+
+    std::size_t chunk_size_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* pos_ = nullptr;
+    std::size_t left_ = 0u;
+    std::size_t size_ = 0u;
+};
+
+}
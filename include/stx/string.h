@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -8,6 +9,10 @@
 #include <algorithm>
 #include <type_traits>
 #include <iterator>
+#include <memory>
+
+#include "format_sink_impl.h"
+#include "tuple-visit.h"
 
 /* For optional Qt -> std conversions */
 #if defined(QT_CORE_LIB)
@@ -18,30 +23,27 @@
 namespace stx
 {
 
+namespace impl
+{
+
 /**
- * Split string `what` at `at`, return list of parts.
- *
- * Note: Use `container<std::string_view>`, for zero-copy (string) split.
- *       If used, `what` _must_ outlive the result!
+ * Calls `f(part)` for each part of `what` split at `at`.
+ * See `split`.
  */
-template <class _Container = std::vector<std::string>>
-_Container split(std::string_view what,
-                 std::string_view at,
-                 bool removeEmpty = true)
+template <class _Fn>
+void split_each(std::string_view what,
+                std::string_view at,
+                bool removeEmpty,
+                _Fn&& f)
 {
-    using ResultType = typename _Container::value_type;
-
-    _Container container;
-    auto out = std::back_inserter(container);
-
     /* Special case: empty `what` */
     if (what.empty())
-        return container;
+        return;
 
     /* Special case: empty `at` */
     if (at.empty()) {
-        *out++ = ResultType(what);
-        return container;
+        f(what);
+        return;
     }
 
     auto begin = 0ull;
@@ -50,35 +52,230 @@ _Container split(std::string_view what,
     auto next = [&]() {
         if ((end = what.find(at, begin)) != std::string::npos) {
             if (end - begin || !removeEmpty)
-                *out++ = ResultType(what).substr(begin, end - begin);
+                f(what.substr(begin, end - begin));
 
             begin = end + at.size();
             return true;
         }
 
         if (what.size() - begin || !removeEmpty)
-            *out++ = ResultType(what).substr(begin);
+            f(what.substr(begin));
 
         return false;
     };
 
     while (next()) { /* noop */ }
+}
+
+template <class _Container, class = void>
+struct has_allocator_type : std::false_type {};
+
+template <class _Container>
+struct has_allocator_type<_Container, std::void_t<typename _Container::allocator_type>> : std::true_type {};
+
+}
+
+/**
+ * Split string `what` at `at`, return list of parts.
+ *
+ * Note: Use `container<std::string_view>`, for zero-copy (string) split.
+ *       If used, `what` _must_ outlive the result!
+ *
+ * Note: For allocator-aware containers (those with `allocator_type`),
+ *       parts are constructed in-place, so containers like
+ *       `std::pmr::vector<std::pmr::string>` pass `alloc` on to their
+ *       elements. Other containers (e.g. QList) are filled using
+ *       `std::back_inserter`.
+ */
+template <class _Container = std::vector<std::string>,
+          class _Allocator = typename _Container::allocator_type>
+_Container split(std::string_view what,
+                 std::string_view at,
+                 bool removeEmpty = true,
+                 const _Allocator& alloc = {})
+{
+    _Container container(alloc);
+
+    impl::split_each(what, at, removeEmpty, [&container](std::string_view part) {
+        container.emplace_back(part);
+    });
 
     return container;
 }
 
-template <class _Iter>
-std::string join(_Iter begin, _Iter end, const std::string& with)
+template <class _Container,
+          std::enable_if_t<!impl::has_allocator_type<_Container>::value, int> = 0>
+_Container split(std::string_view what,
+                 std::string_view at,
+                 bool removeEmpty = true)
+{
+    using ResultType = typename _Container::value_type;
+
+    _Container container;
+    auto out = std::back_inserter(container);
+
+    impl::split_each(what, at, removeEmpty, [&out](std::string_view part) {
+        *out++ = ResultType(part);
+    });
+
+    return container;
+}
+
+/**
+ * Result of `split_n` and `rsplit_n`: up to `_N` parts, in order of
+ * appearance. Supports structured bindings.
+ */
+template <std::size_t _N>
+struct split_parts
+{
+    std::array<std::string_view, _N> parts{};
+    std::size_t count = 0u; /* Number of parts found */
+
+    constexpr std::string_view operator[](std::size_t index) const
+    {
+        return parts[index];
+    }
+
+    constexpr std::size_t size() const
+    {
+        return count;
+    }
+
+    constexpr auto begin() const
+    {
+        return parts.begin();
+    }
+
+    constexpr auto end() const
+    {
+        return parts.begin() + count;
+    }
+
+    template <std::size_t _Index>
+    constexpr std::string_view get() const
+    {
+        return std::get<_Index>(parts);
+    }
+};
+
+/**
+ * Split string `what` at the first `_N` - 1 occurrences of `at`, without
+ * allocation. The last part holds the unsplit remainder.
+ *
+ * Example:
+ *   auto [host, port] = stx::split_n<2>("localhost:8080", ":");
+ *   stx::split_n<2>("a/b/c", "/")[1] => "b/c"
+ */
+template <std::size_t _N>
+constexpr split_parts<_N> split_n(std::string_view what,
+                                  std::string_view at,
+                                  bool removeEmpty = true)
+{
+    static_assert(_N > 0u);
+    split_parts<_N> result;
+
+    if (at.empty()) {
+        if (!what.empty())
+            result.parts[result.count++] = what;
+        return result;
+    }
+
+    std::size_t begin = 0u;
+    while (result.count + 1u < _N) {
+        const auto end = what.find(at, begin);
+        if (end == std::string_view::npos)
+            break;
+
+        if (end > begin || !removeEmpty)
+            result.parts[result.count++] = what.substr(begin, end - begin);
+        begin = end + at.size();
+    }
+
+    if (removeEmpty) {
+        while (what.substr(begin, at.size()) == at)
+            begin += at.size();
+    }
+
+    if (begin < what.size() || (!removeEmpty && !what.empty()))
+        result.parts[result.count++] = what.substr(begin);
+
+    return result;
+}
+
+/**
+ * Like `split_n`, but splits at the last `_N` - 1 occurrences of `at`;
+ * the first part holds the unsplit remainder.
+ *
+ * Example:
+ *   auto [path, ext] = stx::rsplit_n<2>("archive.tar.gz", ".");
+ *   path => "archive.tar"
+ */
+template <std::size_t _N>
+constexpr split_parts<_N> rsplit_n(std::string_view what,
+                                   std::string_view at,
+                                   bool removeEmpty = true)
+{
+    static_assert(_N > 0u);
+    split_parts<_N> result;
+
+    if (at.empty()) {
+        if (!what.empty())
+            result.parts[result.count++] = what;
+        return result;
+    }
+
+    /* Collect from the right, then reverse. */
+    std::size_t end = what.size();
+    while (result.count + 1u < _N && end >= at.size()) {
+        const auto pos = what.rfind(at, end - at.size());
+        if (pos == std::string_view::npos)
+            break;
+
+        const auto begin = pos + at.size();
+        if (end > begin || !removeEmpty)
+            result.parts[result.count++] = what.substr(begin, end - begin);
+        end = pos;
+    }
+
+    if (removeEmpty) {
+        while (end >= at.size() && what.substr(end - at.size(), at.size()) == at)
+            end -= at.size();
+    }
+
+    if (end > 0u || (!removeEmpty && !what.empty()))
+        result.parts[result.count++] = what.substr(0u, end);
+
+    for (std::size_t i = 0u, j = result.count; i + 1u < j; ++i, --j) {
+        const auto tmp = result.parts[i];
+        result.parts[i] = result.parts[j - 1u];
+        result.parts[j - 1u] = tmp;
+    }
+
+    return result;
+}
+
+/**
+ * Join range `begin` to `end` with separator `with`, using allocator
+ * `alloc` for the result of type `_String`.
+ *
+ * Example:
+ *   join<std::pmr::string>(std::allocator_arg, &arena, begin, end, "/")
+ */
+template <class _String, class _Iter>
+_String join(std::allocator_arg_t,
+             const typename _String::allocator_type& alloc,
+             _Iter begin, _Iter end,
+             std::string_view with)
 {
     if (begin == end)
-        return {};
+        return _String(alloc);
 
-    std::size_t withSize = (std::min<std::size_t>(std::distance(begin, end), 1u) - 1u) * with.size();
+    std::size_t withSize = (std::max<std::size_t>(std::distance(begin, end), 1u) - 1u) * with.size();
     std::size_t size = std::accumulate(begin, end, 0ull, [](auto init, const auto& v) {
         return init + v.size();
     });
 
-    std::string result;
+    _String result(alloc);
     result.reserve(size + withSize);
 
     std::for_each(begin, end, [&, i = 0u](const auto& v) mutable {
@@ -90,10 +287,41 @@ std::string join(_Iter begin, _Iter end, const std::string& with)
     return result;
 }
 
+/**
+ * Join range `begin` to `end` with separator `with`.
+ */
+template <class _Iter>
+std::string join(_Iter begin, _Iter end, std::string_view with)
+{
+    return join<std::string>(std::allocator_arg, {}, begin, end, with);
+}
+
+/**
+ * Join range `begin` to `end` with separator `with`, writing to
+ * output iterator `out`. Returns the iterator behind the last
+ * written char.
+ *
+ * Writes in bulk to char pointers and back_insert_iterators of
+ * appendable containers (e.g. std::string or `string_builder`).
+ */
+template <class _Out, class _Iter>
+_Out join_to(_Out out, _Iter begin, _Iter end, std::string_view with)
+{
+    for (auto i = begin; i != end; ++i) {
+        if (i != begin)
+            out = format_impl::write(out, with.data(), with.size());
+
+        const std::string_view v(*i);
+        out = format_impl::write(out, v.data(), v.size());
+    }
+
+    return out;
+}
+
 namespace impl
 {
 
-template <class>
+template <class, class = void>
 struct from_string;
 
 template <>
@@ -232,49 +460,63 @@ std::string to_string(_T&& v)
 }
 
 /**
+ * Convert T to string of type `_String`, using allocator `alloc`.
  *
+ * Example:
+ *   to_string<std::pmr::string>(std::allocator_arg, &arena, 123)
  */
-
-namespace impl
-{
-
-template <std::size_t _Index1>
-struct get_as_string
+template <class _String, class _T>
+_String to_string(std::allocator_arg_t,
+                  const typename _String::allocator_type& alloc,
+                  _T&& v)
 {
-    static constexpr std::size_t Index0 = _Index1 - 1u;
-
-    template <class... _Types>
-    static std::string get(const std::size_t index,
-                           const std::tuple<_Types...>& tuple)
-    {
-        return index == Index0
-            ? stx::to_string(std::get<Index0>(tuple))
-            : get_as_string<_Index1 - 1u>::get(index, tuple);
+    if constexpr (std::is_same_v<_String, std::string>) {
+        (void)alloc;
+        return stx::to_string(std::forward<_T>(v));
+    } else if constexpr (std::is_convertible_v<const std::decay_t<_T>&, std::string_view>) {
+        /* Construct string-like values directly, without a temporary std::string. */
+        const std::string_view sv(v);
+        return _String(sv.data(), sv.size(), alloc);
+    } else {
+        const auto str = impl::to_string<std::decay_t<_T>>::to(std::forward<_T>(v));
+        return _String(str.data(), str.size(), alloc);
     }
-};
-
+}
 
-template <>
-struct get_as_string<0u>
+/**
+ * Runtime std::get<> alternative, returning the value as string (using to_string).
+ * Out of range indices return an empty string of type `_String`,
+ * using allocator `alloc`.
+ */
+template <class _String, class _Tuple>
+_String get_as_string(std::allocator_arg_t,
+                      const typename _String::allocator_type& alloc,
+                      const std::size_t index,
+                      const _Tuple& values)
 {
-    template <class... _Types>
-    static std::string get(const std::size_t,
-                           const std::tuple<_Types...>&)
-    {
-        return {};
+    if constexpr (std::tuple_size_v<_Tuple> == 0u) {
+        (void)index;
+        (void)values;
+        return _String(alloc);
+    } else {
+        if (index >= std::tuple_size_v<_Tuple>)
+            return _String(alloc);
+
+        return visit_at(index, values, [&alloc](const auto& value) {
+            return stx::to_string<_String>(std::allocator_arg, alloc, value);
+        });
     }
-};
-
 }
 
 /**
  * Runtime std::get<> alternative, returning the value as string (using to_string).
+ * Out of range indices return an empty string.
  */
 template <class _Tuple>
 std::string get_as_string(const std::size_t index,
                           const _Tuple& values)
 {
-    return impl::get_as_string<std::tuple_size_v<_Tuple>>::get(index, values);
+    return get_as_string<std::string>(std::allocator_arg, {}, index, values);
 }
 
 /**
@@ -283,27 +525,31 @@ std::string get_as_string(const std::size_t index,
  *
  * E.g.: "We all live in a ? ?" with ("yellow", "submarine") returns
  *       "We all live in a yellow submarine"
+ *
+ * The result (and all replacements) use the allocator of `source`.
  */
-template <class... _Args>
-std::string replace_with(std::string source,
-                         const std::string& what,
-                         _Args&& ...with)
+template <class _Traits, class _Alloc, class... _Args>
+std::basic_string<char, _Traits, _Alloc> replace_with(std::basic_string<char, _Traits, _Alloc> source,
+                                                      std::string_view what,
+                                                      _Args&& ...with)
 {
+    using String = std::basic_string<char, _Traits, _Alloc>;
+
     auto tuple = std::tie(with...);
 
     auto find_next = [&](auto start) {
-        start = source.find(what, start);
-        if (start != std::string::npos) {
+        start = source.find(what.data(), start, what.size());
+        if (start != String::npos) {
             return start;
         }
 
-        return std::string::npos;
+        return String::npos;
     };
 
     std::size_t index = 0u;
-    std::string::size_type pos = 0u;
-    while ((pos = find_next(pos)) != std::string::npos) {
-        auto replacement = get_as_string(index++, tuple);
+    typename String::size_type pos = 0u;
+    while ((pos = find_next(pos)) != String::npos) {
+        auto replacement = get_as_string<String>(std::allocator_arg, source.get_allocator(), index++, tuple);
         source.replace(pos, what.size(), replacement);
         pos += replacement.size();
     }
@@ -311,8 +557,26 @@ std::string replace_with(std::string source,
     return source;
 }
 
-template <class _Iter>
-std::string to_hex(_Iter begin, _Iter end, bool upcase = false)
+template <class... _Args>
+std::string replace_with(std::string_view source,
+                         std::string_view what,
+                         _Args&& ...with)
+{
+    return replace_with(std::string(source), what, std::forward<_Args>(with)...);
+}
+
+/**
+ * Convert range `begin` to `end` of integral values to a hex string
+ * of type `_String`, using allocator `alloc`.
+ *
+ * Example:
+ *   to_hex<std::pmr::string>(std::allocator_arg, &arena, begin, end)
+ */
+template <class _String, class _Iter>
+_String to_hex(std::allocator_arg_t,
+               const typename _String::allocator_type& alloc,
+               _Iter begin, _Iter end,
+               bool upcase = false)
 {
     const char* charset[2] = {"0123456789abcdef", "0123456789ABCDEF"};
 
@@ -320,7 +584,7 @@ std::string to_hex(_Iter begin, _Iter end, bool upcase = false)
     static_assert(std::is_integral_v<ValueType>);
     const auto type_size = sizeof(ValueType);
 
-    std::string str;
+    _String str(alloc);
     str.reserve(2u * std::distance(begin, end) * type_size);
     std::for_each(begin, end, [&](const auto v) {
         auto i = type_size - 1u;
@@ -334,4 +598,27 @@ std::string to_hex(_Iter begin, _Iter end, bool upcase = false)
     return str;
 }
 
+/**
+ * Convert range `begin` to `end` of integral values to a hex string.
+ */
+template <class _Iter>
+std::string to_hex(_Iter begin, _Iter end, bool upcase = false)
+{
+    return to_hex<std::string>(std::allocator_arg, {}, begin, end, upcase);
+}
+
+}
+
+namespace std
+{
+
+template <std::size_t _N>
+struct tuple_size<stx::split_parts<_N>> : std::integral_constant<std::size_t, _N> {};
+
+template <std::size_t _Index, std::size_t _N>
+struct tuple_element<_Index, stx::split_parts<_N>>
+{
+    using type = std::string_view;
+};
+
 }
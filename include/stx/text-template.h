@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "string.h"
+
+namespace stx
+{
+
+/**
+ * Text with named placeholders, compiled once into segments and
+ * re-rendered incrementally.
+ *
+ * Placeholders are written as `{name}`, use `{{` and `}}` for literal
+ * braces. Placeholders render empty until set. The rendered text is
+ * kept; setting a value replaces only the occurrences of its
+ * placeholder and records the changed byte ranges. Values of unchanged
+ * size are overwritten in place, otherwise the text following the
+ * first occurrence is moved once.
+ *
+ * Example:
+ *   text_template t("CPU: {cpu}% | RAM: {ram}%");
+ *   t.set("cpu", 12);
+ *   t.set("ram", 80);
+ *   t.str() => "CPU: 12% | RAM: 80%"
+ *   t.set("cpu", 13);
+ *   t.changes() => {{5, 2, 2}}  (plus the changes before)
+ */
+class text_template
+{
+public:
+    /**
+     * Changed byte range of the rendered text: `old_size` bytes
+     * at `offset` were replaced by `size` bytes. Offsets refer
+     * to the text after applying all previous changes.
+     */
+    struct change
+    {
+        std::size_t offset;
+        std::size_t old_size;
+        std::size_t size;
+
+        bool operator==(const change& o) const
+        {
+            return offset == o.offset && old_size == o.old_size && size == o.size;
+        }
+    };
+
+    explicit text_template(std::string_view source)
+    {
+        compile(source);
+    }
+
+    /**
+     * Set the value of placeholder `name`, re-rendering its occurrences.
+     *
+     * Returns false if the template has no placeholder `name`.
+     */
+    template <class _Type>
+    bool set(std::string_view name, const _Type& value)
+    {
+        if constexpr (std::is_convertible_v<const _Type&, std::string_view>) {
+            return set_value(name, std::string_view(value));
+        } else {
+            return set_value(name, to_string(value));
+        }
+    }
+
+    /**
+     * Returns the current value of placeholder `name`.
+     */
+    std::string_view get(std::string_view name) const
+    {
+        auto iter = placeholders_.find(name);
+        if (iter == placeholders_.end())
+            return {};
+        return values_[iter->second];
+    }
+
+    /**
+     * Returns true if the template contains placeholder `name`.
+     */
+    bool contains(std::string_view name) const
+    {
+        return placeholders_.find(name) != placeholders_.end();
+    }
+
+    /**
+     * The rendered text.
+     */
+    const std::string& str() const
+    {
+        return output_;
+    }
+
+    /**
+     * Changes since construction or the last `clear_changes` call.
+     */
+    const std::vector<change>& changes() const
+    {
+        return changes_;
+    }
+
+    void clear_changes()
+    {
+        changes_.clear();
+    }
+
+private:
+    static constexpr std::size_t literal = static_cast<std::size_t>(-1);
+
+    struct segment
+    {
+        std::size_t offset; /* Offset in output_ */
+        std::size_t size;
+        std::size_t slot;   /* Placeholder index or `literal` */
+    };
+
+    void compile(std::string_view source)
+    {
+        auto add_literal = [this](std::string_view text) {
+            if (text.empty())
+                return;
+
+            if (!segments_.empty() && segments_.back().slot == literal) {
+                segments_.back().size += text.size();
+            } else {
+                segments_.push_back({output_.size(), text.size(), literal});
+            }
+            output_.append(text);
+        };
+
+        std::size_t pos = 0u;
+        while (pos < source.size()) {
+            const auto brace = source.find_first_of("{}", pos);
+            if (brace == std::string_view::npos) {
+                add_literal(source.substr(pos));
+                break;
+            }
+
+            add_literal(source.substr(pos, brace - pos));
+
+            /* Escaped brace */
+            if (brace + 1u < source.size() && source[brace + 1u] == source[brace]) {
+                add_literal(source.substr(brace, 1u));
+                pos = brace + 2u;
+                continue;
+            }
+
+            const auto close = source[brace] == '{' ? source.find_first_of("{}", brace + 1u) : std::string_view::npos;
+            if (close == std::string_view::npos || source[close] != '}') {
+                /* Unmatched brace, keep as is. */
+                add_literal(source.substr(brace, 1u));
+                pos = brace + 1u;
+                continue;
+            }
+
+            const auto name = source.substr(brace + 1u, close - brace - 1u);
+            auto iter = placeholders_.find(name);
+            if (iter == placeholders_.end()) {
+                iter = placeholders_.emplace(std::string(name), values_.size()).first;
+                values_.emplace_back();
+                occurrences_.emplace_back();
+            }
+
+            occurrences_[iter->second].push_back(segments_.size());
+            segments_.push_back({output_.size(), 0u, iter->second});
+            pos = close + 1u;
+        }
+    }
+
+    bool set_value(std::string_view name, std::string_view value)
+    {
+        auto iter = placeholders_.find(name);
+        if (iter == placeholders_.end())
+            return false;
+
+        const auto slot = iter->second;
+        if (values_[slot] == value)
+            return true;
+
+        /* Values taken from `str()` would be overwritten while moving. */
+        if (!value.empty() && std::less_equal<>()(output_.data(), value.data()) &&
+            std::less<>()(value.data(), output_.data() + output_.size()))
+            return set_value(name, std::string(value));
+
+        const auto& occurrences = occurrences_[slot];
+        const auto old_size = values_[slot].size();
+
+        if (value.size() == old_size) {
+            /* Same size: overwrite in place, nothing moves. */
+            for (const auto index : occurrences)
+                std::memcpy(&output_[segments_[index].offset], value.data(), value.size());
+        } else {
+            move_segments(occurrences, old_size, value);
+        }
+
+        for (const auto index : occurrences) {
+            const auto& seg = segments_[index];
+            changes_.push_back({seg.offset, old_size, value.size()});
+        }
+
+        values_[slot].assign(value.data(), value.size());
+        return true;
+    }
+
+    /**
+     * Replace all `occurrences` (of size `old_size`) by `value` in a
+     * single pass: segments following the first occurrence are moved
+     * once, by the running size difference, and their offsets updated.
+     */
+    void move_segments(const std::vector<std::size_t>& occurrences, std::size_t old_size, std::string_view value)
+    {
+        const auto first = occurrences.front();
+        const auto slot = segments_[first].slot;
+        auto* out = &output_[0];
+
+        if (value.size() < old_size) {
+            /* Shrinking: move front to back, then cut the end. */
+            const auto delta = old_size - value.size();
+            std::size_t shift = 0u;
+            for (auto i = first; i < segments_.size(); ++i) {
+                auto& seg = segments_[i];
+                const auto offset = seg.offset - shift;
+                if (seg.slot == slot) {
+                    std::memcpy(out + offset, value.data(), value.size());
+                    seg.size = value.size();
+                    shift += delta;
+                } else if (shift) {
+                    std::memmove(out + offset, out + seg.offset, seg.size);
+                }
+                seg.offset = offset;
+            }
+            output_.resize(output_.size() - shift);
+        } else {
+            /* Growing: extend the end, then move back to front. */
+            const auto delta = value.size() - old_size;
+            auto shift = delta * occurrences.size();
+            output_.resize(output_.size() + shift);
+            out = &output_[0];
+
+            for (auto i = segments_.size(); i-- > first;) {
+                auto& seg = segments_[i];
+                if (seg.slot == slot) {
+                    shift -= delta;
+                    std::memcpy(out + seg.offset + shift, value.data(), value.size());
+                    seg.size = value.size();
+                } else if (shift) {
+                    std::memmove(out + seg.offset + shift, out + seg.offset, seg.size);
+                }
+                seg.offset += shift;
+            }
+        }
+    }
+
+    std::string output_;
+    std::vector<segment> segments_;
+    std::map<std::string, std::size_t, std::less<>> placeholders_; /* Name -> slot */
+    std::vector<std::string> values_;                             /* Per slot */
+    std::vector<std::vector<std::size_t>> occurrences_;            /* Per slot, segment indices */
+    std::vector<change> changes_;
+};
+
+}
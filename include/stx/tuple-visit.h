@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stx
+{
+
+namespace tuple_visit_impl
+{
+
+template <std::size_t _I, class _Result, class _Tuple, class _Fn>
+constexpr _Result visit_one(_Tuple& tuple, _Fn& f)
+{
+    return f(std::get<_I>(tuple));
+}
+
+template <class _Result, class _Tuple, class _Fn, class _Sequence>
+struct table;
+
+template <class _Result, class _Tuple, class _Fn, std::size_t... _I>
+struct table<_Result, _Tuple, _Fn, std::index_sequence<_I...>>
+{
+    static constexpr _Result (*fns[])(_Tuple&, _Fn&) = {&visit_one<_I, _Result, _Tuple, _Fn>...};
+};
+
+}
+
+/**
+ * Calls `f(std::get<index>(tuple))` for runtime index `index`, which must
+ * be less than the tuple size. Dispatches through a table of function
+ * pointers (one indirect call, independent of the tuple size).
+ *
+ * The result type is that of `f(std::get<0>(tuple))`; the results of all
+ * other elements must be convertible to it.
+ *
+ * Example:
+ *   auto t = std::make_tuple(1, "two", 3.0);
+ *   stx::visit_at(1, t, [](const auto& v) { return stx::format("{}", v); }) => "two"
+ */
+template <class _Tuple, class _Fn>
+constexpr decltype(auto) visit_at(std::size_t index, _Tuple&& tuple, _Fn&& f)
+{
+    using Tuple = std::remove_reference_t<_Tuple>;
+    using Fn = std::remove_reference_t<_Fn>;
+    using Result = decltype(f(std::get<0u>(tuple)));
+
+    constexpr auto size = std::tuple_size_v<std::remove_cv_t<Tuple>>;
+    static_assert(size > 0u, "visit_at requires a non-empty tuple");
+
+    return tuple_visit_impl::table<Result, Tuple, Fn, std::make_index_sequence<size>>::fns[index](tuple, f);
+}
+
+}
@@ -0,0 +1,51 @@
+#include "alloc-counter.h"
+
+#include <cstdlib>
+#include <new>
+
+/* Per thread, so allocations of other threads do not disturb a measurement. */
+static thread_local std::size_t allocations = 0u;
+
+namespace stx::test
+{
+
+std::size_t global_allocations()
+{
+    return allocations;
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1u))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
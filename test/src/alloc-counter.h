@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace stx::test
+{
+
+/**
+ * Number of global `operator new` calls made by the calling thread.
+ *
+ * The counting operator new/delete replacements live in alloc-counter.cpp.
+ */
+std::size_t global_allocations();
+
+/**
+ * Counts the global heap allocations made by the calling thread
+ * since construction.
+ *
+ * Example:
+ *   stx::test::alloc_counter allocs;
+ *   auto r = stx::format("{}", 123);
+ *   REQUIRE(allocs.count() <= 1u);
+ */
+struct alloc_counter
+{
+    std::size_t start = global_allocations();
+
+    std::size_t count() const
+    {
+        return global_allocations() - start;
+    }
+};
+
+/**
+ * Memory resource counting all allocations forwarded to `upstream`.
+ */
+struct counting_resource : std::pmr::memory_resource
+{
+    std::pmr::memory_resource* upstream;
+    std::size_t allocations = 0u;
+    std::size_t deallocations = 0u;
+    std::size_t bytes = 0u;
+
+    explicit counting_resource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream(upstream)
+    {}
+
+private:
+    void* do_allocate(std::size_t size, std::size_t align) override
+    {
+        ++allocations;
+        bytes += size;
+        return upstream->allocate(size, align);
+    }
+
+    void do_deallocate(void* p, std::size_t size, std::size_t align) override
+    {
+        ++deallocations;
+        upstream->deallocate(p, size, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/**
+ * Installs `resource` as the default memory resource for the lifetime
+ * of the object.
+ */
+struct scoped_default_resource
+{
+    std::pmr::memory_resource* previous;
+
+    explicit scoped_default_resource(std::pmr::memory_resource* resource)
+        : previous(std::pmr::set_default_resource(resource))
+    {}
+
+    ~scoped_default_resource()
+    {
+        std::pmr::set_default_resource(previous);
+    }
+};
+
+}
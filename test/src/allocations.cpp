@@ -0,0 +1,302 @@
+#include <catch2/catch_all.hpp>
+
+#include "alloc-counter.h"
+
+#include "stx/format.h"
+#include "stx/capture.h"
+#include "stx/enum.h"
+#include "stx/string.h"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+enum class permission : unsigned { read = 1, write = 2, exec = 4, admin = 8, audit = 16 };
+STX_ENUM_FLAGS(permission, permission::read, permission::write, permission::exec, permission::admin, permission::audit)
+
+}
+
+/* All tests measure first and check afterwards, as REQUIRE itself
+ * may allocate. */
+
+SCENARIO("format allocates at most once", "[stx::alloc][stx::format::format]") {
+    GIVEN("A format string producing a result not longer than the format string") {
+        WHEN("Formatting integers and strings") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::format("Values: {} {} {} (placeholder padding...)", 1, "two", 3.0);
+            auto n = allocs.count();
+
+            THEN("Expecting a single allocation for the result") {
+                REQUIRE(r == "Values: 1 two 3 (placeholder padding...)");
+                REQUIRE(n <= 1u);
+            }
+        }
+    }
+
+    GIVEN("A short result") {
+        WHEN("Formatting a single integer") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::format("{}", 42);
+            auto n = allocs.count();
+
+            THEN("Expecting no allocation (small string)") {
+                REQUIRE(r == "42");
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("format of a single string allocates once", "[stx::alloc][stx::format::format]") {
+    GIVEN("A long string") {
+        const std::string long_value(1000u, 'x');
+
+        WHEN("Formatting it unpadded and padded") {
+            stx::test::alloc_counter allocs1;
+            auto r1 = stx::format("{}", long_value);
+            auto n1 = allocs1.count();
+
+            stx::test::alloc_counter allocs2;
+            auto r2 = stx::format("{:>1010}", long_value);
+            auto n2 = allocs2.count();
+
+            THEN("Expecting bulk appends instead of per-char growth") {
+                REQUIRE(r1 == long_value);
+                REQUIRE(r2.size() == 1010u);
+                REQUIRE(n1 <= 1u);
+                REQUIRE(n2 <= 2u);
+            }
+        }
+    }
+}
+
+SCENARIO("format_to does not allocate", "[stx::alloc][stx::format::format_to]") {
+    GIVEN("A preallocated output string") {
+        std::string out;
+        out.reserve(256u);
+
+        WHEN("Formatting into it") {
+            stx::test::alloc_counter allocs;
+            stx::format_to(std::back_inserter(out), "{:>10}|{:_<10}|{:^9}|{:0x}|{}", 123, "abc", true, 255, 1.5);
+            auto n = allocs.count();
+
+            THEN("Expecting no allocation") {
+                REQUIRE(out == "       123|abc_______|  true   |ff|1.5");
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("format_to_n and format_fixed do not allocate", "[stx::alloc][stx::format::format_to_n]") {
+    GIVEN("A long string argument") {
+        const std::string long_value = "a-long-value-that-does-not-fit-sso";
+
+        WHEN("Formatting into a char buffer and a fixed_string") {
+            char buffer[16];
+
+            stx::test::alloc_counter allocs;
+            auto r1 = stx::format_to_n(buffer, sizeof(buffer), "{:>40} {} {} {:0x}", long_value, 1.5, true, 255);
+            auto r2 = stx::format_fixed<64>("{:>40} {} {} {:0x}", long_value, 1.5, true, 255);
+            auto n = allocs.count();
+
+            THEN("Expecting no allocation") {
+                REQUIRE(r1.size == 52u);
+                REQUIRE(r2.size() == 52u);
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("capture_to and format_captured_to do not allocate", "[stx::alloc][stx::capture]") {
+    GIVEN("Preallocated record and output buffers") {
+        std::string records;
+        records.reserve(1024u);
+        std::string out;
+        out.reserve(1024u);
+        const std::string long_value = "a-long-value-that-does-not-fit-sso";
+
+        /* The first capture registers the format string. */
+        stx::capture_to(records, "{} {:>10} {}", 0, long_value, 1.5);
+        records.clear();
+
+        WHEN("Capturing and rendering records") {
+            stx::test::alloc_counter allocs;
+            for (auto i = 0; i < 8; ++i)
+                stx::capture_to(records, "{} {:>10} {}", i, long_value, 1.5);
+            stx::format_captured_to(std::back_inserter(out), records);
+            auto n = allocs.count();
+
+            THEN("Expecting no allocation") {
+                REQUIRE(n == 0u);
+                REQUIRE(out.size() == 8u * 40u);
+            }
+        }
+    }
+}
+
+SCENARIO("format_to of ranges does not allocate", "[stx::alloc][stx::format::format_to]") {
+    GIVEN("A preallocated output string and a range") {
+        std::string out;
+        out.reserve(256u);
+        const std::vector<std::string> range(4u, "a-long-token-that-does-not-fit-sso");
+
+        WHEN("Formatting the range") {
+            stx::test::alloc_counter allocs;
+            stx::format_to(std::back_inserter(out), "{:s/:>40}", range);
+            auto n = allocs.count();
+
+            THEN("Expecting no intermediate strings") {
+                REQUIRE(out.size() == 4u * 40u + 3u + 2u);
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("format_to of flag enums does not allocate", "[stx::alloc][stx::enum]") {
+    GIVEN("A preallocated output string and a combination of flags") {
+        std::string out;
+        out.reserve(256u);
+        const auto flags = static_cast<permission>(0x7f);
+
+        WHEN("Formatting the flags") {
+            stx::test::alloc_counter allocs;
+            stx::format_to(std::back_inserter(out), "{:>50}", flags);
+            auto n = allocs.count();
+
+            THEN("Expecting no intermediate strings") {
+                REQUIRE(out == std::string(18u, ' ') + "read|write|exec|admin|audit|0x60");
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("split allocates only container storage", "[stx::alloc][stx::string::split]") {
+    GIVEN("A string with long tokens") {
+        const std::string what = "a-long-token-that-does-not-fit-sso/another-long-token-that-does-not-fit-sso";
+
+        WHEN("Splitting into string_views") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::split<std::vector<std::string_view>>(what, "/");
+            auto n = allocs.count();
+
+            THEN("Expecting only vector growth allocations") {
+                REQUIRE(r.size() == 2u);
+                REQUIRE(n <= 2u);
+            }
+        }
+
+        WHEN("Splitting into strings") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::split(what, "/");
+            auto n = allocs.count();
+
+            THEN("Expecting one allocation per token plus vector growth") {
+                REQUIRE(r.size() == 2u);
+                REQUIRE(n <= 4u);
+            }
+        }
+
+        WHEN("Splitting into a pmr vector of string_views") {
+            std::array<std::byte, 1024u> buffer;
+            std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+            stx::test::counting_resource resource(&arena);
+            stx::test::scoped_default_resource scope(&resource);
+
+            stx::test::alloc_counter allocs;
+            auto r = stx::split<std::pmr::vector<std::string_view>>(what, "/");
+            auto n = allocs.count();
+
+            THEN("Expecting all allocations to be served by the container's resource") {
+                REQUIRE(r.size() == 2u);
+                REQUIRE(resource.allocations > 0u);
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("join allocates once", "[stx::alloc][stx::string::join]") {
+    GIVEN("A range of strings") {
+        const std::vector<std::string> range(10u, "a-long-token-that-does-not-fit-sso");
+
+        WHEN("Joining with a separator") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::join(range.begin(), range.end(), "/");
+            auto n = allocs.count();
+
+            THEN("Expecting a single, exactly sized allocation") {
+                REQUIRE(r.size() == 10u * range.front().size() + 9u);
+                REQUIRE(n == 1u);
+            }
+        }
+    }
+}
+
+SCENARIO("replace_with allocates at most once per growth", "[stx::alloc][stx::string::replace_with]") {
+    GIVEN("A template with short replacements") {
+        WHEN("Replacing") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::replace_with("?, ?, ?", "?", 1, "b", 3);
+            auto n = allocs.count();
+
+            THEN("Expecting no allocation (small strings)") {
+                REQUIRE(r == "1, b, 3");
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
+
+SCENARIO("to_hex allocates once", "[stx::alloc][stx::string::to_hex]") {
+    GIVEN("A byte range") {
+        const std::array<std::uint8_t, 64u> bytes{};
+
+        WHEN("Converting to hex") {
+            stx::test::alloc_counter allocs;
+            auto r = stx::to_hex(bytes.begin(), bytes.end());
+            auto n = allocs.count();
+
+            THEN("Expecting a single allocation") {
+                REQUIRE(r.size() == 128u);
+                REQUIRE(n == 1u);
+            }
+        }
+    }
+}
+
+SCENARIO("pmr string functions allocate from the arena only", "[stx::alloc][stx::string::pmr]") {
+    GIVEN("A stack backed arena without upstream") {
+        std::array<std::byte, 4096u> buffer;
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+        const std::string long_value = "a-long-value-that-does-not-fit-sso";
+        const std::vector<std::string_view> range(4u, long_value);
+
+        WHEN("Calling format, join, split, replace_with, to_hex and to_string") {
+            stx::test::alloc_counter allocs;
+            auto r1 = stx::format<std::pmr::string>(std::allocator_arg, &arena, "{} {}", long_value, 1);
+            auto r2 = stx::join<std::pmr::string>(std::allocator_arg, &arena, range.begin(), range.end(), "/");
+            auto r3 = stx::split<std::pmr::vector<std::pmr::string>>(r2, "/", true, &arena);
+            auto r4 = stx::replace_with(std::pmr::string("?/?", &arena), "?", long_value, long_value);
+            auto r5 = stx::to_hex<std::pmr::string>(std::allocator_arg, &arena, long_value.begin(), long_value.end());
+            auto r6 = stx::to_string<std::pmr::string>(std::allocator_arg, &arena, long_value);
+            auto n = allocs.count();
+
+            THEN("Expecting no global heap allocation") {
+                REQUIRE(r1.size() == long_value.size() + 2u);
+                REQUIRE(r3.size() == 4u);
+                REQUIRE(r4.size() == 2u * long_value.size() + 1u);
+                REQUIRE(r5.size() == 2u * long_value.size());
+                REQUIRE(std::string_view(r6) == long_value);
+                REQUIRE(n == 0u);
+            }
+        }
+    }
+}
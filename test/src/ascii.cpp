@@ -0,0 +1,145 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/ascii.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+SCENARIO("Trimming ASCII whitespace", "[stx::ascii]") {
+    GIVEN("Strings with leading and trailing whitespace") {
+        THEN("Expecting the whitespace to be removed") {
+            REQUIRE(stx::trim("") == "");
+            REQUIRE(stx::trim(" \t\n\v\f\r") == "");
+            REQUIRE(stx::trim("  a b  ") == "a b");
+            REQUIRE(stx::trim_left("  a b  ") == "a b  ");
+            REQUIRE(stx::trim_right("  a b  ") == "  a b");
+            REQUIRE(stx::trim("\xa0x\xa0") == "\xa0x\xa0");
+        }
+
+        THEN("Whitespace runs of all lengths around the vector width are removed") {
+            for (std::size_t n = 0u; n < 70u; ++n) {
+                const auto ws = std::string(n, n % 2 ? ' ' : '\t');
+                REQUIRE(stx::trim(ws + "value" + ws) == "value");
+                REQUIRE(stx::trim(ws) == "");
+                REQUIRE(stx::trim_left(ws + "x" + ws).size() == n + 1u);
+                REQUIRE(stx::trim_right(ws + "x" + ws).size() == n + 1u);
+            }
+        }
+    }
+}
+
+SCENARIO("Converting ASCII case", "[stx::ascii]") {
+    GIVEN("All byte values") {
+        std::string all;
+        for (auto i = 0; i < 256 * 3; ++i)
+            all.push_back(static_cast<char>(i % 256));
+
+        std::string lower = all;
+        std::string upper = all;
+        for (auto& c : lower)
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(std::tolower(c));
+        for (auto& c : upper)
+            if (c >= 'a' && c <= 'z')
+                c = static_cast<char>(std::toupper(c));
+
+        THEN("Only ASCII letters are converted") {
+            REQUIRE(stx::to_lower(all) == lower);
+            REQUIRE(stx::to_upper(all) == upper);
+
+            for (std::size_t n = 0u; n < 70u; ++n)
+                REQUIRE(stx::to_lower(all.substr(60u, n)) == lower.substr(60u, n));
+        }
+
+        THEN("In place and output iterator variants yield the same results") {
+            auto s = all;
+            REQUIRE(stx::to_lower_in_place(s) == lower);
+            REQUIRE(stx::to_upper_in_place(s) == upper);
+
+            std::string out;
+            stx::to_lower_to(std::back_inserter(out), all);
+            REQUIRE(out == lower);
+
+            std::vector<char> buffer(all.size());
+            REQUIRE(stx::to_upper_to(buffer.data(), all) == buffer.data() + all.size());
+            REQUIRE(std::string(buffer.begin(), buffer.end()) == upper);
+        }
+    }
+}
+
+SCENARIO("Comparing ASCII strings case-insensitively", "[stx::ascii]") {
+    GIVEN("Strings differing in case only") {
+        const std::string a = "Content-Type: Application/JSON; charset=UTF-8";
+        const std::string b = "content-type: application/json; CHARSET=utf-8";
+
+        THEN("Expecting them to be equal") {
+            REQUIRE(stx::iequals(a, b));
+            REQUIRE(stx::iequals("", ""));
+            REQUIRE(!stx::iequals(a, b.substr(1)));
+            REQUIRE(!stx::iequals("[", "{"));
+            REQUIRE(!stx::iequals("@", "`"));
+            REQUIRE(stx::starts_with_ci(a, "CONTENT-type"));
+            REQUIRE(!stx::starts_with_ci("a", "ab"));
+            REQUIRE(stx::ends_with_ci(a, "Utf-8"));
+            REQUIRE(!stx::ends_with_ci(a, "utf-7"));
+        }
+
+        THEN("Differences at every position are found") {
+            for (std::size_t i = 0u; i < a.size(); ++i) {
+                auto c = b;
+                c[i] = '#';
+                REQUIRE(!stx::iequals(a, c));
+            }
+        }
+    }
+
+    GIVEN("Strings with non-ASCII bytes") {
+        THEN("Expecting is_ascii to detect them") {
+            REQUIRE(stx::is_ascii("plain text"));
+            REQUIRE(!stx::is_ascii("gr\xc3\xbc\xc3\x9f"));
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. */
+TEST_CASE("ascii benchmark", "[stx::ascii][.benchmark]") {
+    /* Tokens as produced by splitting a text file. */
+    std::vector<std::string> tokens;
+    for (int i = 0; i < 10000; ++i)
+        tokens.push_back("   Token-" + std::to_string(i) + " With MIXED Case Text " + std::string(static_cast<std::size_t>(i % 32), 'X') + "\t\r\n");
+
+    BENCHMARK("trim and to_lower_in_place") {
+        std::size_t size = 0u;
+        for (const auto& token : tokens) {
+            std::string trimmed(stx::trim(token));
+            size += stx::to_lower_in_place(trimmed).size();
+        }
+        return size;
+    };
+
+    BENCHMARK("<cctype> loops") {
+        std::size_t size = 0u;
+        for (const auto& token : tokens) {
+            auto first = token.begin();
+            auto last = token.end();
+            while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+                ++first;
+            while (last != first && std::isspace(static_cast<unsigned char>(*(last - 1))))
+                --last;
+
+            std::string trimmed(first, last);
+            for (auto& c : trimmed)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            size += trimmed.size();
+        }
+        return size;
+    };
+
+    BENCHMARK("is_ascii") {
+        std::size_t count = 0u;
+        for (const auto& token : tokens)
+            count += stx::is_ascii(token);
+        return count;
+    };
+}
@@ -0,0 +1,272 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/async-sink.h"
+#include "stx/string.h"
+
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#define STX_TEST_FILENO _fileno
+#define STX_TEST_NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define STX_TEST_FILENO fileno
+#define STX_TEST_NULL_DEVICE "/dev/null"
+#endif
+
+namespace
+{
+
+std::string read_all(std::FILE* file)
+{
+    std::string content;
+    std::fflush(file);
+    std::rewind(file);
+
+    char buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1u, sizeof(buffer), file)) > 0u)
+        content.append(buffer, n);
+    return content;
+}
+
+/* Pipe, which stalls its writer once full */
+bool open_pipe(int (&fds)[2])
+{
+#if defined(_WIN32)
+    return _pipe(fds, 4096u, _O_BINARY) == 0;
+#else
+    return ::pipe(fds) == 0;
+#endif
+}
+
+std::string read_until_eof(int fd)
+{
+    std::string content;
+    char buffer[4096];
+#if defined(_WIN32)
+    int n;
+    while ((n = _read(fd, buffer, sizeof(buffer))) > 0)
+#else
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+#endif
+        content.append(buffer, static_cast<std::size_t>(n));
+    return content;
+}
+
+void close_fd(int fd)
+{
+#if defined(_WIN32)
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+}
+
+SCENARIO("Writing to an async sink", "[stx::async_sink]") {
+    GIVEN("A temporary file") {
+        auto* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        const auto fd = STX_TEST_FILENO(file);
+
+        WHEN("Writing from multiple threads") {
+            constexpr auto threads = 4;
+            constexpr auto messages = 5000;
+            {
+                stx::async_sink sink(fd, 4096u);
+
+                std::vector<std::thread> producers;
+                for (auto t = 0; t < threads; ++t)
+                    producers.emplace_back([&sink, t] {
+                        for (auto i = 0; i < messages; ++i)
+                            sink.write("thread {} seq {}\n", t, i);
+                    });
+                for (auto& p : producers)
+                    p.join();
+            }
+
+            THEN("All messages are written in per-thread order") {
+                const auto content = read_all(file);
+                const auto lines = stx::split<std::vector<std::string_view>>(content, "\n");
+                REQUIRE(lines.size() == threads * messages);
+
+                std::vector<int> next(threads, 0);
+                for (auto line : lines) {
+                    const auto parts = stx::split<std::vector<std::string>>(line, " ");
+                    REQUIRE(parts.size() == 4u);
+
+                    const auto t = std::stoi(parts[1]);
+                    REQUIRE(std::stoi(parts[3]) == next[t]);
+                    ++next[t];
+                }
+            }
+        }
+
+        WHEN("Writing raw messages and flushing") {
+            stx::async_sink sink(fd);
+            REQUIRE(sink.write_raw("Hello, "));
+            REQUIRE(sink.write("{}!", "World"));
+            sink.flush();
+
+            THEN("Flushed messages are visible") {
+                REQUIRE(read_all(file) == "Hello, World!");
+                REQUIRE(sink.dropped() == 0u);
+                REQUIRE(sink.good());
+            }
+        }
+
+        WHEN("Writing more than fits using the drop policy") {
+            constexpr auto messages = 20000;
+            std::size_t written = 0u;
+            std::size_t dropped = 0u;
+            {
+                stx::async_sink sink(fd, 4096u, stx::backpressure::drop);
+                for (auto i = 0; i < messages; ++i)
+                    written += sink.write("message {:>100}\n", i) ? 1u : 0u;
+                dropped = sink.dropped();
+            }
+
+            THEN("Every message is either written or dropped") {
+                REQUIRE(written + dropped == messages);
+
+                const auto content = read_all(file);
+                const auto lines = stx::split<std::vector<std::string_view>>(content, "\n");
+                REQUIRE(lines.size() == written);
+            }
+        }
+
+        WHEN("Writing a message larger than the buffer") {
+            stx::async_sink sink(fd, 4096u, stx::backpressure::drop);
+
+            THEN("It is dropped") {
+                REQUIRE(!sink.write("{:>10000}", 1));
+                REQUIRE(sink.dropped() == 1u);
+            }
+        }
+
+        WHEN("Writing long messages using the block policy") {
+            const std::string large(10000u, 'x');
+            {
+                stx::async_sink sink(fd, 4096u);
+                REQUIRE(sink.write("first\n"));
+                REQUIRE(sink.write("{}\n", large.substr(0u, 1000u)));
+                REQUIRE(sink.write("{}\n", large));
+                REQUIRE(sink.write_raw(large + "\n"));
+                REQUIRE(sink.write("last\n"));
+                REQUIRE(sink.dropped() == 0u);
+            }
+
+            THEN("They are written in order") {
+                REQUIRE(read_all(file) == "first\n" + large.substr(0u, 1000u) + "\n" + large + "\n" + large + "\nlast\n");
+            }
+        }
+
+        std::fclose(file);
+    }
+
+    GIVEN("A pipe, which is not read until all messages are written") {
+        int fds[2];
+        REQUIRE(open_pipe(fds));
+
+        WHEN("Writing more than fits using the count policy") {
+            /* 20000 messages of 108 bytes exceed buffer and pipe capacity by far,
+             * the consumer is stalled on the full pipe. */
+            constexpr auto messages = 20000;
+            std::size_t written = 0u;
+            std::size_t dropped = 0u;
+            std::string content;
+            std::thread reader;
+            {
+                stx::async_sink sink(fds[1], 4096u, stx::backpressure::count);
+                for (auto i = 0; i < messages; ++i)
+                    written += sink.write("message {:>100}\n", i) ? 1u : 0u;
+                dropped = sink.dropped();
+
+                reader = std::thread([&content, fd = fds[0]] { content = read_until_eof(fd); });
+            }
+            close_fd(fds[1]);
+            reader.join();
+            close_fd(fds[0]);
+
+            THEN("Dropped messages are reported") {
+                REQUIRE(dropped > 0u);
+                REQUIRE(written + dropped == messages);
+
+                std::size_t lines = 0u;
+                std::size_t reported = 0u;
+                for (auto line : stx::split<std::vector<std::string_view>>(content, "\n")) {
+                    if (line.substr(0u, 8u) == "message ") {
+                        ++lines;
+                    } else {
+                        const auto parts = stx::split<std::vector<std::string>>(line, " ");
+                        REQUIRE(parts.size() == 3u);
+                        REQUIRE(parts[0].front() == '[');
+                        REQUIRE(parts[2] == "dropped]");
+                        reported += std::stoul(parts[0].substr(1u));
+                    }
+                }
+
+                REQUIRE(lines == written);
+                REQUIRE(reported == dropped);
+            }
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. Each thread
+ * writes 10000 messages to the null device. */
+TEST_CASE("async_sink benchmark", "[stx::async_sink][.benchmark]") {
+    constexpr int messages = 10000;
+
+    auto* file = std::fopen(STX_TEST_NULL_DEVICE, "wb");
+    REQUIRE(file != nullptr);
+    const auto fd = STX_TEST_FILENO(file);
+
+    auto run = [](std::size_t threads, auto&& f) {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0u; t < threads; ++t)
+            workers.emplace_back(f, static_cast<int>(t));
+        for (auto& worker : workers)
+            worker.join();
+    };
+
+    for (std::size_t threads : {1u, 2u, 4u}) {
+        BENCHMARK("async_sink, threads: " + std::to_string(threads)) {
+            stx::async_sink sink(fd);
+            run(threads, [&](int t) {
+                for (int i = 0; i < messages; ++i)
+                    sink.write("{} [thread {}] message {}: {}\n", 1700000000 + i, t, i, "some log text");
+            });
+            sink.flush();
+            return sink.dropped();
+        };
+
+        /* Format and write on the calling thread, behind a mutex. */
+        BENCHMARK("mutex and write, threads: " + std::to_string(threads)) {
+            std::mutex mutex;
+            run(threads, [&](int t) {
+                std::string line;
+                for (int i = 0; i < messages; ++i) {
+                    std::lock_guard lock(mutex);
+                    line.clear();
+                    stx::format_to(std::back_inserter(line), "{} [thread {}] message {}: {}\n", 1700000000 + i, t, i, "some log text");
+                    const stx::io_impl::buffer buffer{line.data(), line.size()};
+                    stx::io_impl::write_all(fd, &buffer, 1u);
+                }
+            });
+            return threads;
+        };
+    }
+
+    std::fclose(file);
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/base64.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/* Straightforward reference encoder. */
+std::string reference_base64(std::string_view data, bool url, bool pad)
+{
+    const std::string chars = url
+        ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+        : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    std::uint32_t bits = 0u;
+    int count = 0;
+    for (auto c : data) {
+        bits = (bits << 8) | static_cast<std::uint8_t>(c);
+        count += 8;
+        while (count >= 6) {
+            count -= 6;
+            out.push_back(chars[(bits >> count) & 0x3f]);
+        }
+    }
+    if (count > 0)
+        out.push_back(chars[(bits << (6 - count)) & 0x3f]);
+    while (pad && out.size() % 4u)
+        out.push_back('=');
+    return out;
+}
+
+std::string random_bytes(std::size_t size, std::mt19937& rng)
+{
+    std::string data(size, '\0');
+    for (auto& c : data)
+        c = static_cast<char>(rng() & 0xffu);
+    return data;
+}
+
+}
+
+SCENARIO("Base64 encoding and decoding", "[stx::base64]") {
+    GIVEN("The RFC 4648 test vectors") {
+        const std::vector<std::pair<std::string, std::string>> vectors = {
+            {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+            {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+        };
+
+        THEN("Expecting the documented encodings") {
+            for (const auto& [data, encoded] : vectors) {
+                REQUIRE(stx::to_base64(data) == encoded);
+                REQUIRE(stx::from_base64(encoded) == data);
+                REQUIRE(stx::base64_encoded_size(data.size()) == encoded.size());
+                REQUIRE(stx::base64_decoded_size(encoded) == data.size());
+            }
+        }
+
+        THEN("Padding is optional") {
+            REQUIRE(stx::to_base64("fo", stx::base64_alphabet::standard, false) == "Zm8");
+            REQUIRE(stx::from_base64("Zm8") == "fo");
+            REQUIRE(stx::from_base64("Zg") == "f");
+        }
+    }
+
+    GIVEN("Random data of all sizes around the vector widths") {
+        std::mt19937 rng(42);
+
+        THEN("Expecting the reference encoding and lossless round trips") {
+            for (std::size_t size = 0u; size < 300u; ++size) {
+                const auto data = random_bytes(size, rng);
+                for (auto url : {false, true}) {
+                    for (auto pad : {false, true}) {
+                        const auto alphabet = url ? stx::base64_alphabet::url : stx::base64_alphabet::standard;
+                        const auto encoded = stx::to_base64(data, alphabet, pad);
+
+                        REQUIRE(encoded == reference_base64(data, url, pad));
+                        REQUIRE(stx::base64_encoded_size(size, pad) == encoded.size());
+                        REQUIRE(stx::from_base64(encoded, alphabet) == data);
+                    }
+                }
+            }
+        }
+
+        THEN("Output iterators yield the same results") {
+            const auto data = random_bytes(5000u, rng);
+            const auto encoded = stx::to_base64(data);
+
+            std::string out;
+            stx::encode_base64(std::back_inserter(out), data);
+            REQUIRE(out == encoded);
+
+            std::vector<std::uint8_t> bytes;
+            REQUIRE(stx::decode_base64(std::back_inserter(bytes), encoded));
+            REQUIRE(std::string(bytes.begin(), bytes.end()) == data);
+        }
+    }
+
+    GIVEN("Invalid input") {
+        std::mt19937 rng(7);
+        const auto valid = stx::to_base64(random_bytes(120u, rng));
+
+        THEN("Decoding fails") {
+            REQUIRE(!stx::from_base64("Z"));
+            REQUIRE(!stx::from_base64("Zg="));
+            REQUIRE(!stx::from_base64("Zg=a"));
+            REQUIRE(!stx::from_base64("Zm9v Yg=="));
+            REQUIRE(!stx::from_base64("Zm9v-_==", stx::base64_alphabet::standard));
+            REQUIRE(!stx::from_base64("Zm9v+/==", stx::base64_alphabet::url));
+
+            /* Invalid chars at every position of a vectorized block. */
+            for (std::size_t i = 0u; i < valid.size(); ++i) {
+                for (auto c : {'*', '=', '\x80', '-', '\0'}) {
+                    /* A trailing '=' is valid padding. */
+                    if (c == '=' && i + 1u == valid.size())
+                        continue;
+
+                    auto text = valid;
+                    text[i] = c;
+                    REQUIRE(!stx::from_base64(text));
+                }
+            }
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. */
+TEST_CASE("base64 benchmark", "[stx::base64][.benchmark]") {
+    std::mt19937 rng(42);
+    const auto data = random_bytes(16u << 20u, rng);
+    const auto encoded = stx::to_base64(data);
+
+    std::string text(encoded.size(), '\0');
+    std::string bytes(data.size(), '\0');
+
+    BENCHMARK("encode_base64, 16 MiB") {
+        return stx::encode_base64(&text[0], data) - &text[0];
+    };
+
+    BENCHMARK("decode_base64, 16 MiB") {
+        return *stx::decode_base64(&bytes[0], encoded) - &bytes[0];
+    };
+
+    BENCHMARK("reference encoder, 16 MiB") {
+        return reference_base64(data, false, true).size();
+    };
+}
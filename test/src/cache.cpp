@@ -0,0 +1,230 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stx/cache.h"
+
+SCENARIO("lru_cache evicts the least recently used entry", "[stx::lru_cache]") {
+    GIVEN("A cache of 3 entries") {
+        stx::lru_cache<int, std::string> cache(3u);
+        cache.insert_or_assign(1, "one");
+        cache.insert_or_assign(2, "two");
+        cache.insert_or_assign(3, "three");
+
+        WHEN("Using entry 1 and inserting entry 4") {
+            REQUIRE(cache.value_or(1, "") == "one");
+            cache.insert_or_assign(4, "four");
+
+            THEN("Expecting entry 2 to be evicted") {
+                REQUIRE(cache.size() == 3u);
+                REQUIRE(cache.contains(1));
+                REQUIRE(!cache.contains(2));
+                REQUIRE(cache.contains(3));
+                REQUIRE(cache.contains(4));
+                REQUIRE(cache.stats().evictions == 1u);
+            }
+        }
+
+        WHEN("Replacing an entry") {
+            cache.insert_or_assign(1, "uno");
+
+            THEN("Expecting no eviction") {
+                REQUIRE(cache.size() == 3u);
+                REQUIRE(cache.value_or(1, "") == "uno");
+                REQUIRE(cache.stats().evictions == 0u);
+            }
+        }
+
+        WHEN("Calling get_or_compute") {
+            int calls = 0;
+            auto compute = [&](int key) {
+                ++calls;
+                return std::to_string(key);
+            };
+
+            THEN("Expecting it to compute misses only") {
+                REQUIRE(cache.get_or_compute(2, compute) == "two");
+                REQUIRE(calls == 0);
+                REQUIRE(cache.get_or_compute(5, compute) == "5");
+                REQUIRE(calls == 1);
+                REQUIRE(cache.get_or_compute(5, compute) == "5");
+                REQUIRE(calls == 1);
+
+                /* 1 was least recently used */
+                REQUIRE(!cache.contains(1));
+                REQUIRE(cache.stats().hits == 2u);
+                REQUIRE(cache.stats().misses == 1u);
+            }
+        }
+
+        WHEN("Inserting the value of the entry it evicts") {
+            const auto& one = *cache.find(1);
+            REQUIRE(cache.value_or(2, "") == "two");
+            REQUIRE(cache.value_or(3, "") == "three");
+            cache.insert_or_assign(4, one);
+
+            THEN("Expecting the value to be copied before eviction") {
+                REQUIRE(!cache.contains(1));
+                REQUIRE(cache.value_or(4, "") == "one");
+            }
+        }
+
+        WHEN("Erasing and clearing") {
+            REQUIRE(cache.erase(2));
+            REQUIRE(!cache.erase(2));
+            cache.insert_or_assign(4, "four");
+            cache.insert_or_assign(5, "five");
+
+            THEN("Expecting freed entries to be reused") {
+                REQUIRE(cache.size() == 3u);
+                REQUIRE(!cache.contains(1));
+                REQUIRE(cache.value_or(3, "") == "three");
+                REQUIRE(cache.value_or(5, "") == "five");
+
+                cache.clear();
+                REQUIRE(cache.size() == 0u);
+                REQUIRE(cache.value_or(3, "none") == "none");
+            }
+        }
+    }
+
+    GIVEN("A cache limited in bytes") {
+        stx::lru_cache<int, std::string> cache(100u, 3u * (sizeof(int) + sizeof(std::string)) + 30u);
+
+        WHEN("Inserting values of 10 chars") {
+            for (int i = 0; i < 10; ++i)
+                cache.insert_or_assign(i, std::string(10u, 'a' + i));
+
+            THEN("Expecting only the last 3 to be kept") {
+                REQUIRE(cache.size() == 3u);
+                REQUIRE(cache.bytes() <= cache.max_bytes());
+                REQUIRE(cache.contains(7));
+                REQUIRE(cache.contains(9));
+                REQUIRE(!cache.contains(6));
+            }
+        }
+
+        WHEN("Inserting a value larger than the limit") {
+            cache.insert_or_assign(1, "small");
+            cache.insert_or_assign(2, std::string(1000u, 'x'));
+
+            THEN("Expecting it to be stored alone") {
+                REQUIRE(cache.size() == 1u);
+                REQUIRE(cache.contains(2));
+            }
+        }
+    }
+
+    GIVEN("A cache limited in bytes only") {
+        stx::lru_cache<int, std::string> unlimited(0u, 1u << 16u);
+        stx::lru_cache<int, std::string> huge(SIZE_MAX, 1u << 16u);
+
+        WHEN("Inserting more values than fit") {
+            for (int i = 0; i < 10000; ++i) {
+                unlimited.insert_or_assign(i, std::string(100u, 'x'));
+                huge.insert_or_assign(i, std::string(100u, 'x'));
+            }
+
+            THEN("Expecting the byte limit to bound the size") {
+                REQUIRE(unlimited.bytes() <= unlimited.max_bytes());
+                REQUIRE(unlimited.size() > 100u);
+                REQUIRE(unlimited.size() < 1000u);
+                REQUIRE(unlimited.contains(9999));
+                REQUIRE(!unlimited.contains(0));
+                REQUIRE(huge.size() == unlimited.size());
+            }
+        }
+    }
+
+    GIVEN("A large cache") {
+        stx::lru_cache<int, int> cache(1000u);
+
+        WHEN("Inserting and erasing many keys") {
+            for (int i = 0; i < 5000; ++i) {
+                cache.insert_or_assign(i, i);
+                if (i % 3 == 0)
+                    cache.erase(i - 1);
+            }
+
+            THEN("Expecting the index to stay consistent") {
+                REQUIRE(cache.size() <= 1000u);
+                for (int i = 4500; i < 5000; ++i)
+                    REQUIRE(cache.value_or(i, -1) == ((i + 1) % 3 == 0 && i < 4999 ? -1 : i));
+            }
+        }
+    }
+}
+
+SCENARIO("clock_cache gives referenced entries a second chance", "[stx::clock_cache]") {
+    GIVEN("A cache of 3 entries") {
+        stx::clock_cache<int, int> cache(3u);
+        cache.insert_or_assign(1, 10);
+        cache.insert_or_assign(2, 20);
+        cache.insert_or_assign(3, 30);
+
+        WHEN("Inserting more entries") {
+            cache.insert_or_assign(4, 40);
+            REQUIRE(cache.value_or(4, 0) == 40);
+            cache.insert_or_assign(5, 50);
+
+            THEN("Expecting the size to be bounded") {
+                REQUIRE(cache.size() == 3u);
+                REQUIRE(cache.contains(4));
+                REQUIRE(cache.contains(5));
+                REQUIRE(cache.stats().evictions == 2u);
+            }
+        }
+
+        WHEN("Using value_or with a lvalue fallback") {
+            const int fallback = -1;
+
+            THEN("Expecting references to be returned") {
+                REQUIRE(&cache.value_or(9, fallback) == &fallback);
+                REQUIRE(cache.value_or(2, fallback) == 20);
+            }
+        }
+    }
+}
+
+SCENARIO("sharded_cache is thread-safe", "[stx::sharded_cache]") {
+    GIVEN("A sharded cache") {
+        stx::sharded_cache<stx::lru_cache<int, int>> cache(1024u, 0u, 8u);
+
+        WHEN("Computing values from multiple threads") {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&cache]() {
+                    for (int i = 0; i < 2000; ++i)
+                        (void)cache.get_or_compute(i % 500, [](int key) { return key * 2; });
+                });
+            }
+            for (auto& t : threads)
+                t.join();
+
+            THEN("Expecting consistent values") {
+                REQUIRE(cache.size() == 500u);
+                for (int i = 0; i < 500; ++i)
+                    REQUIRE(cache.value_or(i, -1) == i * 2);
+
+                const auto stats = cache.stats();
+                REQUIRE(stats.hits + stats.misses == 4u * 2000u + 500u);
+            }
+        }
+    }
+
+    GIVEN("A sharded cache limited in bytes only") {
+        stx::sharded_cache<stx::lru_cache<int, int>> cache(SIZE_MAX, 1u << 16u, 8u);
+
+        WHEN("Inserting values") {
+            for (int i = 0; i < 100; ++i)
+                cache.insert_or_assign(i, i);
+
+            THEN("Expecting no entry limit") {
+                REQUIRE(cache.size() == 100u);
+            }
+        }
+    }
+}
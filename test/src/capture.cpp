@@ -0,0 +1,123 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/capture.h"
+#include "stx/format.h"
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+SCENARIO("Capturing arguments for deferred formatting", "[stx::capture]") {
+    GIVEN("Records of different argument types") {
+        std::string records;
+        std::string expected;
+
+        auto check = [&](std::string_view fmt, const auto& ...args) {
+            stx::capture_to(records, fmt, args...);
+            expected += stx::format(fmt, args...);
+        };
+
+        const std::string owned = "owned";
+        check("no arguments");
+        check("{} {} {} {}", 1, -2ll, 3u, 'c');
+        check("{:0>8} {:0x} {:0X}", 42, 255, 255u);
+        check("{} {}", true, false);
+        check("{} {}", 1.5, 0.25f);
+        check("{} | {:_<8} | {:>3}", "literal", owned, std::string_view("view"));
+        check("{1} {0}", "a", 1);
+        check("{}", std::byte{0xab});
+        check("{{ {} }}", 7);
+        check("[{:>3}]", static_cast<const char*>(nullptr));
+
+        THEN("Decoding yields the same output as format") {
+            REQUIRE(stx::format_captured(records) == expected);
+        }
+
+        THEN("Records can be iterated one by one") {
+            std::string_view rest(records);
+            std::size_t count = 0u;
+            while (const auto size = stx::captured_size(rest)) {
+                rest.remove_prefix(size);
+                ++count;
+            }
+
+            REQUIRE(count == 10u);
+            REQUIRE(rest.empty());
+        }
+
+        THEN("Incomplete records are not decoded") {
+            const auto first = stx::captured_size(records);
+            const auto second = stx::captured_size(std::string_view(records).substr(first));
+            const std::string_view truncated(records.data(), first + second - 1u);
+
+            REQUIRE(stx::format_captured(truncated) == "no arguments");
+        }
+
+        THEN("Constant format strings are hashed once") {
+            static constexpr stx::capture_format fmt("{} = {}");
+            static_assert(fmt.id() == stx::capture_format_id("{} = {}"));
+
+            REQUIRE(stx::format_captured(stx::capture(fmt, "x", 1)) == "x = 1");
+        }
+
+        THEN("Strings are copied") {
+            auto record = stx::capture("{}", std::string(1000, 'x'));
+            REQUIRE(stx::format_captured(record) == std::string(1000, 'x'));
+        }
+    }
+
+    GIVEN("Records and a dictionary saved by another process") {
+        const auto records = stx::capture("{:>4}|{}|{}", 42, "text", 2.5);
+
+        std::string saved;
+        stx::capture_formats::global().write_to(saved);
+
+        WHEN("Decoding with the loaded dictionary") {
+            stx::capture_formats formats;
+            REQUIRE(formats.read_from(saved));
+
+            THEN("Expecting the same output as format") {
+                REQUIRE(formats.size() == stx::capture_formats::global().size());
+                REQUIRE(stx::format_captured(records, formats) == "  42|text|2.5");
+            }
+        }
+
+        WHEN("Decoding with a truncated dictionary") {
+            stx::capture_formats formats;
+            REQUIRE(!formats.read_from(std::string_view(saved).substr(0u, saved.size() - 1u)));
+        }
+
+        WHEN("Decoding without the format string") {
+            stx::capture_formats formats;
+
+            THEN("Expecting the record to be skipped") {
+                REQUIRE(stx::format_captured(records + stx::capture("next"), formats).empty());
+                formats.add("next");
+                REQUIRE(stx::format_captured(records + stx::capture("next"), formats) == "next");
+            }
+        }
+    }
+
+    GIVEN("Records captured on one thread") {
+        std::vector<char> records;
+        for (auto i = 0; i < 100; ++i)
+            stx::capture_to(records, "{}:{};", "line", i);
+
+        WHEN("Decoding on another thread") {
+            std::string output;
+            std::thread([&] {
+                stx::format_captured_to(std::back_inserter(output),
+                                        std::string_view(records.data(), records.size()));
+            }).join();
+
+            THEN("Expecting all records") {
+                std::string expected;
+                for (auto i = 0; i < 100; ++i)
+                    expected += stx::format("{}:{};", "line", i);
+
+                REQUIRE(output == expected);
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/chrono.h"
+#include "stx/format.h"
+
+#include <chrono>
+#include <thread>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+template <class _Duration = std::chrono::seconds>
+auto utc(std::int64_t seconds, _Duration fraction = _Duration::zero())
+{
+    return std::chrono::time_point<std::chrono::system_clock, _Duration>(
+        std::chrono::duration_cast<_Duration>(std::chrono::seconds(seconds)) + fraction);
+}
+
+/* 2024-02-29 13:45:07 UTC, a Thursday. */
+constexpr std::int64_t leap_day = 1709214307;
+
+}
+
+SCENARIO("format time points", "[stx::chrono::time_point]") {
+    GIVEN("A time point with seconds precision") {
+        auto tp = utc(leap_day);
+
+        THEN("Expecting the default format") {
+            REQUIRE(stx::format("{}", tp) == "2024-02-29 13:45:07");
+        }
+
+        THEN("Expecting all pattern fields to be rendered") {
+            REQUIRE(stx::format("{:%Y|%y|%m|%d|%H|%M|%S}", tp) == "2024|24|02|29|13|45|07");
+            REQUIRE(stx::format("{:%a %A %b %B}", tp) == "Thu Thursday Feb February");
+            REQUIRE(stx::format("{:%FT%T%z %Z %% %q}", tp) == "2024-02-29T13:45:07+0000 UTC % %q");
+        }
+
+        THEN("Expecting fill, justify and width before the pattern") {
+            REQUIRE(stx::format("{:.>12%T}", tp) == "....13:45:07");
+            REQUIRE(stx::format("[{:10%H:%M}]", tp) == "[13:45     ]");
+        }
+
+        THEN("Expecting %f to be empty") {
+            REQUIRE(stx::format("{:%S.%f|X}", tp) == "07.|X");
+            REQUIRE(stx::format("{:%S.%f|X}", tp) == "07.|X"); /* Cached */
+            REQUIRE(stx::format("{:%T" + std::string(80u, '-') + "%f|X}", tp) == "13:45:07" + std::string(80u, '-') + "|X");
+        }
+    }
+
+    GIVEN("A time point before the epoch") {
+        auto tp = utc<std::chrono::milliseconds>(-14182940, 250ms); /* 1969-07-20 20:17:40.250 */
+
+        THEN("Expecting the date to be correct") {
+            REQUIRE(stx::format("{}", tp) == "1969-07-20 20:17:40.250");
+            REQUIRE(stx::format("{:%a %b}", tp) == "Sun Jul");
+        }
+
+        THEN("Expecting negative fractions to round down") {
+            REQUIRE(stx::format("{}", utc<std::chrono::milliseconds>(0, -1ms)) == "1969-12-31 23:59:59.999");
+        }
+    }
+
+    GIVEN("Time points with sub-second precision") {
+        THEN("Expecting one fraction digit per decimal place") {
+            REQUIRE(stx::format("{}", utc<std::chrono::milliseconds>(leap_day, 7ms)) == "2024-02-29 13:45:07.007");
+            REQUIRE(stx::format("{}", utc<std::chrono::microseconds>(leap_day, 7us)) == "2024-02-29 13:45:07.000007");
+            REQUIRE(stx::format("{:%S.%f}", utc<std::chrono::nanoseconds>(leap_day, 123456789ns)) == "07.123456789");
+        }
+    }
+
+    GIVEN("Repeated formatting within the same second") {
+        THEN("Expecting the cached prefix to be patched correctly") {
+            for (auto ms = 0; ms < 1000; ms += 111) {
+                auto tp = utc<std::chrono::milliseconds>(leap_day, std::chrono::milliseconds(ms));
+                auto expected = stx::format("2024-02-29 13:45:07.{:0>3}", ms);
+
+                REQUIRE(stx::format("{}", tp) == expected);
+                REQUIRE(stx::format("{:%T}", tp) == "13:45:07");
+                REQUIRE(stx::format("{:%f|%f}", tp) == stx::format("{0:0>3}|{0:0>3}", ms));
+            }
+        }
+
+        THEN("Expecting second changes to re-render the prefix") {
+            REQUIRE(stx::format("{}", utc<std::chrono::milliseconds>(leap_day, 999ms)) == "2024-02-29 13:45:07.999");
+            REQUIRE(stx::format("{}", utc<std::chrono::milliseconds>(leap_day, 1000ms)) == "2024-02-29 13:45:08.000");
+        }
+    }
+
+    GIVEN("A pattern longer than the cacheable size") {
+        auto pattern = "{:%T" + std::string(80u, '-') + "%f}";
+
+        THEN("Expecting it to be rendered uncached") {
+            REQUIRE(stx::format(pattern, utc<std::chrono::milliseconds>(leap_day, 5ms)) == "13:45:07" + std::string(80u, '-') + "005");
+        }
+    }
+
+    GIVEN("Multiple threads") {
+        THEN("Expecting each thread to use its own cache") {
+            std::string r1, r2;
+            std::thread t1([&] { r1 = stx::format("{}", utc(leap_day)); });
+            std::thread t2([&] { r2 = stx::format("{:%T}", utc(leap_day + 1)); });
+            t1.join();
+            t2.join();
+
+            REQUIRE(r1 == "2024-02-29 13:45:07");
+            REQUIRE(r2 == "13:45:08");
+        }
+    }
+}
+
+SCENARIO("format durations", "[stx::chrono::duration]") {
+    GIVEN("Durations of various units") {
+        THEN("Expecting count and unit by default") {
+            REQUIRE(stx::format("{}", 42ms) == "42ms");
+            REQUIRE(stx::format("{}", 3ns) == "3ns");
+            REQUIRE(stx::format("{}", 5us) == "5us");
+            REQUIRE(stx::format("{}", 7s) == "7s");
+            REQUIRE(stx::format("{}", 2min) == "2min");
+            REQUIRE(stx::format("{}", 1h) == "1h");
+            REQUIRE(stx::format("{}", -42ms) == "-42ms");
+            REQUIRE(stx::format("{}", std::chrono::duration<int, std::ratio<1, 3>>(2)) == "2[1/3]s");
+            REQUIRE(stx::format("{}", std::chrono::duration<double>(1.5)) == "1.5s");
+        }
+
+        THEN("Expecting pattern fields to be rendered") {
+            REQUIRE(stx::format("{:%T.%f}", 3723004ms) == "01:02:03.004");
+            REQUIRE(stx::format("{:%H:%M}", 50h + 7min) == "50:07");
+            REQUIRE(stx::format("{:%T}", -61s) == "-00:01:01");
+            REQUIRE(stx::format("{:>8%Q%q}", 12ms) == "    12ms");
+            REQUIRE(stx::format("{:%S.%f|X}", 7s) == "07.|X");
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/compiled-format.h"
+#include "stx/format.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+SCENARIO("Formatting with compiled format strings", "[stx::compiled_format]") {
+    GIVEN("Format strings loaded at runtime") {
+        const std::vector<std::string> patterns = {
+            "",
+            "no fields",
+            "{}",
+            "{} {} {}",
+            "{1} {0} {1}",
+            "{:0>5} {:_<6} {:.^3}",
+            "{{ {} }} {{{{",
+            "}} } {",
+            "{:0x} {:0X} {:0o}",
+            "Value: {} of {:>8}.",
+        };
+
+        THEN("Expecting the same output as the plain format string") {
+            for (const auto& p : patterns) {
+                const stx::compiled_format cf(p);
+                REQUIRE(stx::format(cf, 42, "abc", 1.5) == stx::format(p, 42, "abc", 1.5));
+                REQUIRE(stx::format(cf, std::string("x"), 7u, true) == stx::format(p, std::string("x"), 7u, true));
+                if (cf.accepts<>())
+                    REQUIRE(stx::format(cf) == stx::format(p));
+                else
+                    REQUIRE_THROWS_AS(stx::format(cf), std::invalid_argument);
+            }
+        }
+
+        THEN("Repeated formatting yields the same output") {
+            const stx::compiled_format cf("{:>6}|{}");
+            for (auto i = 0; i < 10; ++i)
+                REQUIRE(stx::format(cf, i, "x") == stx::format("{:>6}|{}", i, "x"));
+        }
+    }
+
+    GIVEN("A compiled format string") {
+        const stx::compiled_format cf("{0}, {1}: {2:0>4}");
+
+        THEN("Validating argument lists") {
+            REQUIRE(cf.accepts<int, int, int>());
+            REQUIRE(cf.accepts<int, int, int, int>());
+            REQUIRE(!cf.accepts<int, int>());
+        }
+
+        THEN("Missing arguments throw on every use") {
+            REQUIRE_THROWS_AS(stx::format(cf, "a", "b"), std::invalid_argument);
+            REQUIRE_THROWS_AS(stx::format(cf, "a", "b"), std::invalid_argument);
+            REQUIRE(stx::format(cf, "a", "b", "c") == "a, b: 000c");
+            REQUIRE_THROWS_AS(stx::format(cf, 1), std::invalid_argument);
+        }
+
+        THEN("Different argument types can be used") {
+            REQUIRE(stx::format(cf, "a", "b", 7) == "a, b: 0007");
+            REQUIRE(stx::format(cf, 1, 2.5, "x") == "1, 2.5: 000x");
+            REQUIRE(stx::format(cf, "a", "b", 7) == "a, b: 0007");
+        }
+
+        THEN("Formatting to an output iterator") {
+            std::string out;
+            stx::format_to(std::back_inserter(out), cf, 1, 2, 3);
+            REQUIRE(out == "1, 2: 0003");
+        }
+
+        THEN("Copies are independent") {
+            auto copy = cf;
+            REQUIRE(copy.pattern() == cf.pattern());
+            REQUIRE(stx::format(copy, 1, 2, 3) == "1, 2: 0003");
+        }
+
+        WHEN("Formatting from multiple threads") {
+            std::vector<std::string> results(4u);
+            std::vector<std::thread> threads;
+            for (auto t = 0; t < 4; ++t)
+                threads.emplace_back([&cf, &results, t] {
+                    for (auto i = 0; i < 1000; ++i)
+                        results[t] = stx::format(cf, t, i, i);
+                });
+            for (auto& t : threads)
+                t.join();
+
+            THEN("Expecting the last result of each thread") {
+                for (auto t = 0; t < 4; ++t)
+                    REQUIRE(results[t] == stx::format("{}, 999: 0999", t));
+            }
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. */
+TEST_CASE("compiled_format benchmark", "[stx::compiled_format][.benchmark]") {
+    /* Typical messages, as loaded from a translation file. */
+    const std::string short_pattern = "User {} logged in from {} after {} attempts.";
+    const std::string long_pattern =
+        "Upload of '{:<24}' to {} finished: {:>10} bytes in {} s ({} chunks, {} retries, "
+        "checksum {}). Next sync at {:>8}.";
+
+    const stx::compiled_format short_cf(short_pattern);
+    const stx::compiled_format long_cf(long_pattern);
+
+    const std::string user = "johann";
+    const std::string file = "reports/2024/summary.pdf";
+    const std::string host = "storage-eu-west-1.example.com";
+
+    std::string out;
+    out.reserve(512u);
+
+    BENCHMARK("format, short message") {
+        out.clear();
+        stx::format_to(std::back_inserter(out), short_pattern, user, host, 3);
+        return out.size();
+    };
+
+    BENCHMARK("compiled_format, short message") {
+        out.clear();
+        stx::format_to(std::back_inserter(out), short_cf, user, host, 3);
+        return out.size();
+    };
+
+    BENCHMARK("format, long message") {
+        out.clear();
+        stx::format_to(std::back_inserter(out), long_pattern, file, host, 1048576, 2.5, 16, 0, "9f86d081", "12:00:00");
+        return out.size();
+    };
+
+    BENCHMARK("compiled_format, long message") {
+        out.clear();
+        stx::format_to(std::back_inserter(out), long_cf, file, host, 1048576, 2.5, 16, 0, "9f86d081", "12:00:00");
+        return out.size();
+    };
+}
@@ -0,0 +1,204 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "stx/map.h"
+#include "stx/concurrent-map.h"
+
+SCENARIO("concurrent_map basic operations", "[stx::concurrent_map]") {
+    GIVEN("A concurrent map") {
+        stx::concurrent_map<std::string, int> m(4u);
+
+        WHEN("Inserting values") {
+            REQUIRE(m.insert("a", 1));
+            REQUIRE(!m.insert("a", 2));
+            m.insert_or_assign("b", 3);
+
+            THEN("Expecting lookups to match") {
+                REQUIRE(m.size() == 2u);
+                REQUIRE(m.contains("a"));
+                REQUIRE(!m.contains("c"));
+                REQUIRE(m.get("a") == 1);
+                REQUIRE(!m.get("c"));
+                REQUIRE(m.value_or("b", -1) == 3);
+                REQUIRE(m.value_or("c", -1) == -1);
+            }
+
+            THEN("Expecting stx::value_or to work like for std maps") {
+                const std::string fallback = "c";
+                REQUIRE(stx::value_or(m, std::string("a"), 0) == 1);
+                REQUIRE(stx::value_or(m, fallback, 0) == 0);
+                REQUIRE(std::is_same_v<int, decltype(stx::value_or(m, fallback, 0))>);
+            }
+
+            THEN("Expecting visit and update to access values in place") {
+                int seen = 0;
+                REQUIRE(m.visit("a", [&](const int& v) { seen = v; }));
+                REQUIRE(seen == 1);
+                REQUIRE(!m.visit("c", [&](const int&) { seen = -1; }));
+                REQUIRE(seen == 1);
+
+                REQUIRE(m.update("a", [](int& v) { v += 10; }));
+                REQUIRE(m.value_or("a", 0) == 11);
+            }
+        }
+
+        WHEN("Erasing and clearing") {
+            m.insert_or_assign("a", 1);
+            m.insert_or_assign("b", 2);
+
+            THEN("Expecting entries to be removed") {
+                REQUIRE(m.erase("a"));
+                REQUIRE(!m.erase("a"));
+                REQUIRE(m.size() == 1u);
+
+                m.clear();
+                REQUIRE(m.size() == 0u);
+                REQUIRE(!m.contains("b"));
+            }
+        }
+    }
+
+    GIVEN("A single shard map") {
+        stx::concurrent_map<int, int> m(1u);
+
+        WHEN("Inserting values") {
+            for (int i = 0; i < 100; ++i)
+                m.insert(i, i * 2);
+
+            THEN("Expecting all values to be found") {
+                REQUIRE(m.size() == 100u);
+                for (int i = 0; i < 100; ++i)
+                    REQUIRE(m.value_or(i, -1) == i * 2);
+            }
+        }
+    }
+}
+
+SCENARIO("concurrent_map is thread-safe", "[stx::concurrent_map]") {
+    GIVEN("A map shared by multiple threads") {
+        stx::concurrent_map<int, int> m;
+        constexpr int threads = 4;
+        constexpr int count = 2000;
+
+        WHEN("Writing disjoint keys and reading concurrently") {
+            std::atomic<bool> done{false};
+            std::atomic<int> bad{0};
+
+            std::thread reader([&]() {
+                while (!done.load()) {
+                    for (int i = 0; i < threads * count; i += 97) {
+                        /* A key is either missing or has its final value. */
+                        const auto v = m.value_or(i, -1);
+                        if (v != -1 && v != i)
+                            ++bad;
+                    }
+                }
+            });
+
+            std::vector<std::thread> writers;
+            for (int t = 0; t < threads; ++t) {
+                writers.emplace_back([&m, t]() {
+                    for (int i = t * count; i < (t + 1) * count; ++i)
+                        m.insert_or_assign(i, i);
+                });
+            }
+            for (auto& w : writers)
+                w.join();
+
+            done = true;
+            reader.join();
+
+            THEN("Expecting all values to be present") {
+                REQUIRE(bad == 0);
+                REQUIRE(m.size() == std::size_t(threads * count));
+                for (int i = 0; i < threads * count; ++i)
+                    REQUIRE(m.value_or(i, -1) == i);
+            }
+        }
+
+        WHEN("Updating a shared counter from multiple threads") {
+            m.insert(0, 0);
+
+            std::vector<std::thread> writers;
+            for (int t = 0; t < threads; ++t) {
+                writers.emplace_back([&m]() {
+                    for (int i = 0; i < count; ++i)
+                        m.update(0, [](int& v) { ++v; });
+                });
+            }
+            for (auto& w : writers)
+                w.join();
+
+            THEN("Expecting no lost updates") {
+                REQUIRE(m.value_or(0, 0) == threads * count);
+            }
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. Each thread
+ * does 100000 operations, one in 16 is a write. */
+TEST_CASE("concurrent_map benchmark", "[stx::concurrent_map][.benchmark]") {
+    constexpr int keys = 10000;
+    constexpr int operations = 100000;
+
+    auto run = [](std::size_t threads, auto&& f) {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0u; t < threads; ++t)
+            workers.emplace_back(f, static_cast<int>(t));
+        for (auto& worker : workers)
+            worker.join();
+    };
+
+    stx::concurrent_map<int, int> map;
+    std::unordered_map<int, int> locked_map;
+    std::shared_mutex mutex;
+    for (int i = 0; i < keys; ++i) {
+        map.insert(i, i);
+        locked_map.emplace(i, i);
+    }
+
+    for (std::size_t threads : {1u, 2u, 4u, 8u}) {
+        BENCHMARK("concurrent_map, threads: " + std::to_string(threads)) {
+            std::atomic<long> sum{0};
+            run(threads, [&](int t) {
+                long local = 0;
+                for (int i = 0; i < operations; ++i) {
+                    const auto key = (i * 7919 + t) % keys;
+                    if (i % 16 == 0)
+                        map.insert_or_assign(key, i);
+                    else
+                        local += stx::value_or(map, key, -1);
+                }
+                sum += local;
+            });
+            return sum.load();
+        };
+
+        BENCHMARK("shared_mutex map, threads: " + std::to_string(threads)) {
+            std::atomic<long> sum{0};
+            run(threads, [&](int t) {
+                long local = 0;
+                for (int i = 0; i < operations; ++i) {
+                    const auto key = (i * 7919 + t) % keys;
+                    if (i % 16 == 0) {
+                        std::unique_lock lock(mutex);
+                        locked_map[key] = i;
+                    } else {
+                        std::shared_lock lock(mutex);
+                        local += stx::value_or(locked_map, key, -1);
+                    }
+                }
+                sum += local;
+            });
+            return sum.load();
+        };
+    }
+}
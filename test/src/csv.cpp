@@ -0,0 +1,321 @@
+#include <catch2/catch_all.hpp>
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stx/csv.h"
+
+namespace
+{
+
+using rows = std::vector<std::vector<std::string>>;
+
+rows read_all(stx::csv_reader& reader, rows result = {})
+{
+    std::vector<std::string_view> row;
+    while (reader.read_row(row))
+        result.emplace_back(row.begin(), row.end());
+    return result;
+}
+
+rows parse(std::string_view text, char delimiter = ',', bool removeEmpty = false)
+{
+    stx::csv_reader reader(delimiter, removeEmpty);
+    reader.feed(text);
+    reader.finish();
+    return read_all(reader);
+}
+
+/* Char by char reference parser */
+rows parse_reference(std::string_view text)
+{
+    rows result;
+    std::vector<std::string> row;
+    std::string field;
+    bool quoted = false;
+    bool at_start = true;
+
+    auto end_row = [&]() {
+        /* An empty line has no fields. */
+        if (!row.empty() || !field.empty() || !at_start)
+            row.push_back(field);
+        result.push_back(row);
+        row.clear();
+        field.clear();
+        at_start = true;
+    };
+
+    for (std::size_t i = 0u; i < text.size(); ++i) {
+        const auto c = text[i];
+        if (quoted) {
+            if (c == '"' && i + 1u < text.size() && text[i + 1u] == '"') {
+                field.push_back('"');
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field.push_back(c);
+            }
+        } else if (c == '"' && at_start) {
+            quoted = true;
+            at_start = false;
+        } else if (c == ',') {
+            row.push_back(field);
+            field.clear();
+            at_start = true;
+        } else if (c == '\n') {
+            end_row();
+        } else {
+            field.push_back(c);
+            at_start = false;
+        }
+    }
+
+    if (!row.empty() || !field.empty() || !at_start)
+        end_row();
+    return result;
+}
+
+}
+
+SCENARIO("csv_reader parses RFC 4180 CSV", "[stx::csv]") {
+    GIVEN("Simple rows") {
+        THEN("Expecting fields split at delimiters and newlines") {
+            REQUIRE(parse("a,b,c\n1,2,3\n") == rows{{"a", "b", "c"}, {"1", "2", "3"}});
+            REQUIRE(parse("a,b\r\n1,2\r\n") == rows{{"a", "b"}, {"1", "2"}});
+            REQUIRE(parse("a;b\n", ';') == rows{{"a", "b"}});
+        }
+
+        THEN("Expecting the last row to not need a newline") {
+            REQUIRE(parse("a,b\n1,2") == rows{{"a", "b"}, {"1", "2"}});
+            REQUIRE(parse("") == rows{});
+        }
+    }
+
+    GIVEN("Empty fields and lines") {
+        THEN("Expecting empty fields to be kept by default") {
+            REQUIRE(parse(",a,,b,\n") == rows{{"", "a", "", "b", ""}});
+            REQUIRE(parse("a\n\nb\n") == rows{{"a"}, {}, {"b"}});
+            REQUIRE(parse("\"\"\n") == rows{{""}});
+        }
+
+        THEN("Expecting empty fields to be removed, if requested") {
+            REQUIRE(parse(",a,,b,\n", ',', true) == rows{{"a", "b"}});
+        }
+    }
+
+    GIVEN("Quoted fields") {
+        THEN("Expecting delimiters and newlines in quotes to be content") {
+            REQUIRE(parse("\"a,b\",\"c\nd\"\n") == rows{{"a,b", "c\nd"}});
+            REQUIRE(parse("\"a\r\n\",b\r\n") == rows{{"a\r\n", "b"}});
+        }
+
+        THEN("Expecting escaped quotes to be unescaped") {
+            REQUIRE(parse("\"say \"\"hi\"\"\",\"\"\"\"\n") == rows{{"say \"hi\"", "\""}});
+        }
+
+        THEN("Expecting unescaped fields to be views into the input") {
+            stx::csv_reader reader;
+            reader.feed("\"abc\",\"a\"\"b\"\n");
+            reader.finish();
+
+            std::vector<std::string_view> row;
+            REQUIRE(reader.read_row(row));
+            REQUIRE(row == std::vector<std::string_view>{"abc", "a\"b"});
+            REQUIRE(!reader.read_row(row));
+            REQUIRE(reader.done());
+        }
+    }
+
+    GIVEN("Quotes in the middle of unquoted fields") {
+        THEN("Expecting them to be content") {
+            REQUIRE(parse("x,5\" pipe,y\nz,w\n") == rows{{"x", "5\" pipe", "y"}, {"z", "w"}});
+            REQUIRE(parse("a\"b\",\"c,d\"\n") == rows{{"a\"b\"", "c,d"}});
+        }
+
+        THEN("Expecting rows to be available without finish") {
+            stx::csv_reader reader;
+            reader.feed("x,5\" pipe,y\nz,w\n");
+            REQUIRE(read_all(reader) == rows{{"x", "5\" pipe", "y"}, {"z", "w"}});
+        }
+
+        THEN("Expecting the quote state to be correct across blocks") {
+            const std::string text = std::string(63u, 'a') + "\"," + std::string(70u, 'b') + "\"\n\"c,\"\n";
+            REQUIRE(parse(text) == rows{{std::string(63u, 'a') + "\"", std::string(70u, 'b') + "\""}, {"c,"}});
+        }
+
+        THEN("Expecting escaped quotes in quoted fields to stay escaped") {
+            REQUIRE(parse("\"\"\"x\"\",\"\"\"\n") == rows{{"\"x\",\""}});
+
+            /* The escape pair straddles the block boundary. */
+            const std::string text = "\"" + std::string(62u, 'a') + "\"\"b\",y\",c\n";
+            REQUIRE(parse(text) == rows{{std::string(62u, 'a') + "\"b", "y\"", "c"}});
+        }
+    }
+
+    GIVEN("Fields spanning multiple 64 char blocks") {
+        const std::string quoted = "\"" + std::string(100u, 'x') + ",\n" + std::string(100u, 'y') + "\"";
+        const std::string text = "a," + quoted + ",b\n" + std::string(130u, 'z') + "\n";
+
+        THEN("Expecting the quote state to carry over") {
+            REQUIRE(parse(text) == rows{
+                {"a", std::string(100u, 'x') + ",\n" + std::string(100u, 'y'), "b"},
+                {std::string(130u, 'z')},
+            });
+        }
+    }
+}
+
+SCENARIO("csv_reader streams input", "[stx::csv]") {
+    GIVEN("Input fed in chunks") {
+        std::string text;
+        for (int i = 0; i < 200; ++i)
+            text += std::to_string(i) + ",\"q" + std::to_string(i) + ",\"\"x\"\"\",\r\n";
+
+        const auto expected = parse(text);
+        REQUIRE(expected.size() == 200u);
+        REQUIRE(expected[7] == std::vector<std::string>{"7", "q7,\"x\"", ""});
+
+        for (std::size_t chunk : {1u, 7u, 64u, 1000u}) {
+            WHEN("Feeding chunks of " + std::to_string(chunk) + " chars") {
+                stx::csv_reader reader;
+                rows result;
+                for (std::size_t i = 0u; i < text.size(); i += chunk) {
+                    reader.feed(std::string_view(text).substr(i, chunk));
+                    result = read_all(reader, std::move(result));
+                }
+                reader.finish();
+                result = read_all(reader, std::move(result));
+
+                THEN("Expecting the same rows") {
+                    REQUIRE(result == expected);
+                    REQUIRE(reader.done());
+                }
+            }
+        }
+    }
+
+    GIVEN("A long quoted field fed in small chunks") {
+        const std::string field(1u << 20u, 'x');
+        const auto text = "a,\"" + field + "\",b\n";
+
+        THEN("Expecting the row once complete") {
+            stx::csv_reader reader;
+            rows result;
+            for (std::size_t i = 0u; i < text.size(); i += 16u) {
+                reader.feed(std::string_view(text).substr(i, 16u));
+                result = read_all(reader, std::move(result));
+            }
+            REQUIRE(result == rows{{"a", field, "b"}});
+        }
+    }
+}
+
+SCENARIO("csv_reader matches a reference parser", "[stx::csv]") {
+    GIVEN("Random CSV input") {
+        std::mt19937 rng(42u);
+        const char alphabet[] = {'a', 'b', ',', '\n', '"', ' '};
+
+        THEN("Expecting the same rows as the reference parser") {
+            for (int n = 0; n < 200; ++n) {
+                /* Build well-formed fields, unquoted fields may contain quotes. */
+                std::string text;
+                const auto count = rng() % 300u;
+                for (unsigned i = 0u; i < count; ++i) {
+                    const auto kind = rng() % 4u;
+                    if (kind == 0u) {
+                        text += '"';
+                        for (auto len = rng() % 10u; len > 0u; --len) {
+                            const auto c = alphabet[rng() % sizeof(alphabet)];
+                            text += c;
+                            if (c == '"')
+                                text += '"';
+                        }
+                        text += '"';
+                    } else {
+                        const auto len = rng() % 10u;
+                        for (unsigned j = 0u; j < len; ++j)
+                            text += "ab \""[rng() % (j == 0u ? 3u : 4u)];
+                    }
+                    text += (rng() % 4u == 0u) ? '\n' : ',';
+                }
+
+                const auto expected = parse_reference(text);
+                REQUIRE(parse(text) == expected);
+
+                /* Fed in random chunks */
+                stx::csv_reader reader;
+                rows result;
+                for (std::size_t i = 0u; i < text.size();) {
+                    const auto chunk = 1u + rng() % 100u;
+                    reader.feed(std::string_view(text).substr(i, chunk));
+                    result = read_all(reader, std::move(result));
+                    i += chunk;
+                }
+                reader.finish();
+                REQUIRE(read_all(reader, std::move(result)) == expected);
+            }
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. */
+TEST_CASE("csv_reader benchmark", "[stx::csv][.benchmark]") {
+    std::mt19937 rng(42u);
+    auto make_text = [&](const char* quoted_field) {
+        std::string text;
+        while (text.size() < (8u << 20u))
+            text += std::to_string(rng()) + ",some text," + quoted_field + "," + std::to_string(rng() % 1000u) + "\n";
+        return text;
+    };
+
+    auto count_fields = [](std::string_view text) {
+        stx::csv_reader reader;
+        reader.feed(text);
+        reader.finish();
+
+        std::size_t count = 0u;
+        std::vector<std::string_view> row;
+        while (reader.read_row(row))
+            count += row.size();
+        return count;
+    };
+
+    SECTION("Unquoted fields") {
+        const auto text = make_text("plain");
+
+        BENCHMARK("csv_reader") {
+            return count_fields(text);
+        };
+
+        BENCHMARK("char by char reference") {
+            return parse_reference(text).size();
+        };
+    }
+
+    SECTION("Quoted fields") {
+        const auto text = make_text("\"a, \"\"quoted\"\"\nfield\"");
+
+        BENCHMARK("csv_reader") {
+            return count_fields(text);
+        };
+
+        BENCHMARK("char by char reference") {
+            return parse_reference(text).size();
+        };
+    }
+
+    SECTION("Quotes in unquoted fields") {
+        const auto text = make_text("5\" pipe");
+
+        BENCHMARK("csv_reader") {
+            return count_fields(text);
+        };
+
+        BENCHMARK("char by char reference") {
+            return parse_reference(text).size();
+        };
+    }
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/enum.h"
+#include "stx/format.h"
+
+#include <string>
+
+namespace test
+{
+
+enum class color { red, green, blue };
+STX_ENUM_NAMES(color, color::red, color::green, color::blue)
+
+enum status { status_ok = 200, status_not_found = 404, status_error = 500 };
+STX_ENUM_NAMES(status, status_ok, status_not_found, status_error)
+
+enum class access : unsigned { none = 0, read = 1, write = 2, exec = 4, read_write = 3 };
+STX_ENUM_FLAGS(access, access::none, access::read, access::write, access::exec, access::read_write)
+
+enum class code { ok = 0, fine = 0, warning = 1000, failed = -1000000 };
+STX_ENUM_NAMES(code, code::ok, code::fine, code::warning, code::failed)
+
+enum class unregistered { a };
+
+}
+
+static_assert(stx::enum_name(test::color::blue) == "blue");
+static_assert(stx::enum_name(test::status_not_found) == "status_not_found");
+static_assert(!stx::enum_impl::info<test::status>::dense);
+static_assert(stx::enum_name(test::code::fine) == "ok");
+static_assert(stx::enum_name(test::code::failed) == "failed");
+static_assert(!stx::enum_name(static_cast<test::code>(1)));
+static_assert(!stx::enum_name(static_cast<test::color>(7)));
+static_assert(stx::enum_from_string<test::color>("green") == test::color::green);
+static_assert(stx::enum_from_string<test::access>("read | exec") == static_cast<test::access>(5));
+static_assert(stx::enum_values<test::color>().size() == 3u);
+static_assert(!stx::enum_impl::is_registered_v<test::unregistered>);
+
+SCENARIO("Formatting registered enums", "[stx::enum]") {
+    GIVEN("A dense enum") {
+        THEN("Expecting enumerators to be formatted by name") {
+            REQUIRE(stx::format("{}", test::color::red) == "red");
+            REQUIRE(stx::format("{:>6}|{:_<6}", test::color::green, test::color::blue) == " green|blue__");
+            REQUIRE(stx::format("{}", static_cast<test::color>(9)) == "9");
+        }
+    }
+
+    GIVEN("A sparse enum") {
+        THEN("Expecting enumerators to be formatted by name") {
+            REQUIRE(stx::format("{} {}", test::status_ok, test::status_error) == "status_ok status_error");
+            REQUIRE(stx::format("{}", static_cast<test::status>(201)) == "201");
+        }
+    }
+
+    GIVEN("A flag enum") {
+        THEN("Expecting combinations to be joined by |") {
+            REQUIRE(stx::format("{}", test::access::none) == "none");
+            REQUIRE(stx::format("{}", test::access::read_write) == "read_write");
+            REQUIRE(stx::format("{}", static_cast<test::access>(5)) == "read|exec");
+            REQUIRE(stx::format("{}", static_cast<test::access>(7)) == "read|write|exec");
+            REQUIRE(stx::format("{}", static_cast<test::access>(0x14)) == "exec|0x10");
+            REQUIRE(stx::format("{}", static_cast<test::access>(0x10)) == "0x10");
+        }
+
+        THEN("Expecting the joined list to be padded as a whole") {
+            REQUIRE(stx::format("{:>12}|", static_cast<test::access>(5)) == "   read|exec|");
+            REQUIRE(stx::format("{:_^13}|", static_cast<test::access>(0x14)) == "__exec|0x10__|");
+            REQUIRE(stx::format("{:4}|", static_cast<test::access>(7)) == "read|write|exec|");
+        }
+    }
+}
+
+SCENARIO("Parsing registered enums", "[stx::enum]") {
+    GIVEN("Enumerator names") {
+        THEN("Expecting the enumerators") {
+            for (auto value : stx::enum_values<test::color>())
+                REQUIRE(stx::from_string<test::color>(std::string(*stx::enum_name(value))) == value);
+
+            REQUIRE(stx::from_string<test::status>("status_error") == test::status_error);
+            REQUIRE(stx::enum_from_string<test::status>(" status_ok ") == test::status_ok);
+        }
+    }
+
+    GIVEN("Unknown names") {
+        THEN("Expecting no value") {
+            REQUIRE(!stx::enum_from_string<test::color>("purple"));
+            REQUIRE(!stx::enum_from_string<test::color>("red|green"));
+            REQUIRE(!stx::enum_from_string<test::access>("read|"));
+            REQUIRE(stx::from_string<test::color>("purple") == test::color{});
+        }
+    }
+
+    GIVEN("Flag lists") {
+        THEN("Expecting the combined value") {
+            REQUIRE(stx::enum_from_string<test::access>("write|exec") == static_cast<test::access>(6));
+            REQUIRE(stx::enum_from_string<test::access>(stx::format("{}", static_cast<test::access>(7))) ==
+                    static_cast<test::access>(7));
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/fixed-string.h"
+
+#include <cstring>
+
+SCENARIO("fixed_string stores strings inline", "[stx::fixed_string]") {
+    GIVEN("An empty fixed_string") {
+        stx::fixed_string<8> s;
+
+        THEN("Expecting an empty, null-terminated string") {
+            REQUIRE(s.empty());
+            REQUIRE(s.size() == 0u);
+            REQUIRE(s.capacity() == 8u);
+            REQUIRE(std::strlen(s.c_str()) == 0u);
+        }
+
+        WHEN("Appending within capacity") {
+            s.append("Hello");
+            s.push_back('!');
+
+            THEN("Expecting the appended content") {
+                REQUIRE(s == "Hello!");
+                REQUIRE(std::strlen(s.c_str()) == 6u);
+            }
+        }
+
+        WHEN("Appending more than the capacity") {
+            s.append("Hello, ");
+            s.append("World!");
+            s.push_back('!');
+
+            THEN("Expecting the content to be truncated") {
+                REQUIRE(s == "Hello, W");
+                REQUIRE(s.size() == s.capacity());
+                REQUIRE(std::strlen(s.c_str()) == 8u);
+            }
+        }
+    }
+
+    GIVEN("A fixed_string constructed at compile time") {
+        constexpr stx::fixed_string<4> s("abcdef");
+
+        THEN("Expecting the truncated content") {
+            static_assert(s.size() == 4u);
+            REQUIRE(s == "abcd");
+        }
+    }
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/format-batch.h"
+#include "stx/format.h"
+
+#include <cstdio>
+#include <list>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/* Formats as its value, throws for negative values. */
+struct checked
+{
+    int value;
+};
+
+}
+
+template <>
+struct stx::formatter<checked> : stx::formatter<int>
+{
+    using stx::formatter<int>::formatter;
+
+    template <class _Iter>
+    _Iter format(const checked& c, _Iter out)
+    {
+        if (c.value < 0)
+            throw std::invalid_argument("negative");
+        return stx::formatter<int>::format(c.value, out);
+    }
+};
+
+#if defined(_WIN32)
+#define STX_TEST_FILENO _fileno
+#else
+#define STX_TEST_FILENO fileno
+#endif
+
+SCENARIO("Formatting rows in parallel", "[stx::format_batch]") {
+    GIVEN("Many rows of arguments") {
+        std::vector<std::tuple<int, std::string, double>> rows;
+        for (int i = 0; i < 5000; ++i)
+            rows.emplace_back(i, std::string(static_cast<std::size_t>(i % 13), 'a' + i % 26), i * 0.5);
+
+        std::string expected;
+        for (const auto& [i, s, d] : rows)
+            stx::format_to(std::back_inserter(expected), "{:>5}|{:<12}|{}\n", i, s, d);
+
+        WHEN("Formatting with different numbers of threads") {
+            THEN("Expecting the rows in order") {
+                for (std::size_t threads : {0u, 1u, 2u, 3u, 8u})
+                    REQUIRE(stx::format_batch("{:>5}|{:<12}|{}\n", rows, threads) == expected);
+            }
+        }
+
+        WHEN("Formatting to a char buffer") {
+            std::string buffer(expected.size() + 1u, '#');
+            auto end = stx::format_batch_to(&buffer[0], "{:>5}|{:<12}|{}\n", rows, 4u);
+
+            THEN("Expecting the output to be written back to back") {
+                REQUIRE(end == &buffer[0] + expected.size());
+                REQUIRE(buffer.substr(0u, expected.size()) == expected);
+                REQUIRE(buffer.back() == '#');
+            }
+        }
+
+        WHEN("Formatting to a back_inserter") {
+            std::string out = "head\n";
+            stx::format_batch_to(std::back_inserter(out), "{:>5}|{:<12}|{}\n", rows, 4u);
+
+            THEN("Expecting the output to be appended") {
+                REQUIRE(out == "head\n" + expected);
+            }
+        }
+
+        WHEN("Writing to a file") {
+            auto* file = std::tmpfile();
+            REQUIRE(file != nullptr);
+            REQUIRE(stx::write_batch(STX_TEST_FILENO(file), "{:>5}|{:<12}|{}\n", rows, 4u));
+
+            THEN("Expecting the file to contain the rows in order") {
+                std::string content(expected.size(), '\0');
+                std::rewind(file);
+                REQUIRE(std::fread(&content[0], 1u, content.size(), file) == content.size());
+                REQUIRE(content == expected);
+            }
+
+            std::fclose(file);
+        }
+    }
+
+    GIVEN("An arena allocator for the result") {
+        std::pmr::monotonic_buffer_resource arena;
+        std::vector<std::tuple<int>> rows;
+        for (int i = 0; i < 1000; ++i)
+            rows.emplace_back(i);
+
+        THEN("Expecting the result to use the arena") {
+            const auto r = stx::format_batch<std::pmr::string>(std::allocator_arg, &arena, "{};", rows, 2u);
+            REQUIRE(r.get_allocator().resource() == &arena);
+            REQUIRE(std::string_view(r) == stx::format_batch("{};", rows, 1u));
+        }
+    }
+
+    GIVEN("Rows in a non random access range") {
+        std::list<std::pair<std::string, int>> rows;
+        for (int i = 0; i < 1000; ++i)
+            rows.emplace_back("key" + std::to_string(i), i);
+
+        THEN("Expecting the same output as formatting sequentially") {
+            std::string expected;
+            for (const auto& [k, v] : rows)
+                expected += stx::format("{}={};", k, v);
+
+            REQUIRE(stx::format_batch("{}={};", rows, 3u) == expected);
+        }
+    }
+
+    GIVEN("Rows with a formatter throwing on some thread") {
+        std::vector<std::tuple<checked>> rows;
+        for (int i = 0; i < 5000; ++i)
+            rows.emplace_back(checked{i == 4321 ? -1 : i});
+
+        THEN("Expecting the exception on the calling thread") {
+            for (std::size_t threads : {1u, 4u})
+                REQUIRE_THROWS_AS(stx::format_batch("{}\n", rows, threads), std::invalid_argument);
+
+            std::string out;
+            REQUIRE_THROWS_AS(stx::format_batch_to(std::back_inserter(out), "{}\n", rows, 4u), std::invalid_argument);
+            REQUIRE(out.empty());
+        }
+
+        THEN("Expecting valid rows to be formatted") {
+            std::get<0>(rows[4321]).value = 4321;
+            std::string expected;
+            for (int i = 0; i < 5000; ++i)
+                expected += std::to_string(i) + ";";
+
+            REQUIRE(stx::format_batch("{};", rows, 4u) == expected);
+        }
+    }
+
+    GIVEN("No rows") {
+        const std::vector<std::tuple<int>> rows;
+
+        THEN("Expecting empty output") {
+            REQUIRE(stx::format_batch("{}\n", rows).empty());
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. */
+TEST_CASE("format_batch benchmark", "[stx::format_batch][.benchmark]") {
+    std::vector<std::tuple<int, std::string, double>> rows;
+    for (int i = 0; i < 1000000; ++i)
+        rows.emplace_back(i, std::string(static_cast<std::size_t>(i % 13), 'a' + i % 26), i * 0.5);
+
+    BENCHMARK("format_to loop") {
+        std::string out;
+        for (const auto& [i, s, d] : rows)
+            stx::format_to(std::back_inserter(out), "{:>8}|{:<12}|{}\n", i, s, d);
+        return out.size();
+    };
+
+    for (std::size_t threads : {1u, 2u, 4u, 8u, 0u}) {
+        BENCHMARK("format_batch, threads: " + std::to_string(threads)) {
+            return stx::format_batch("{:>8}|{:<12}|{}\n", rows, threads).size();
+        };
+    }
+}
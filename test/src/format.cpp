@@ -4,6 +4,13 @@
 
 #include <cstring>
 #include <limits>
+#include <vector>
+#include <list>
+#include <map>
+#include <tuple>
+#include <optional>
+#include <cstddef>
+#include <memory_resource>
 
 using namespace std::string_literals;
 
@@ -172,3 +179,261 @@ SCENARIO("format a string", "[stx::format::format]") {
         }
     }
 }
+
+SCENARIO("format into an allocator-aware string", "[stx::format::format]") {
+    GIVEN("A monotonic buffer resource") {
+        std::pmr::monotonic_buffer_resource arena;
+
+        WHEN("Formatting with an allocator") {
+            auto r = stx::format<std::pmr::string>(std::allocator_arg, &arena, "{}-{:>5}", "abc", 12);
+
+            THEN("Expecting the result to use the arena") {
+                REQUIRE(r == "abc-   12");
+                REQUIRE(r.get_allocator().resource() == &arena);
+            }
+        }
+    }
+}
+
+SCENARIO("format into a char buffer", "[stx::format::format_to]") {
+    GIVEN("A sufficiently large char buffer") {
+        char buffer[64] = {};
+
+        WHEN("Formatting into it") {
+            auto end = stx::format_to(buffer, "{{ {} }}, {:>4}, {}", "a", 12, true);
+
+            THEN("Expecting the iterator to be advanced by each replacement") {
+                REQUIRE(std::string_view(buffer, end - buffer) == "{ a },   12, true");
+            }
+        }
+    }
+}
+
+SCENARIO("format into a fixed size buffer", "[stx::format::format_to_n]") {
+    GIVEN("A char buffer") {
+        char buffer[8] = {};
+
+        WHEN("The output fits") {
+            auto [out, size] = stx::format_to_n(buffer, sizeof(buffer), "{}:{}", "a", 1);
+
+            THEN("Expecting the complete output") {
+                REQUIRE(size == 3u);
+                REQUIRE(out == buffer + 3);
+                REQUIRE(std::string_view(buffer, 3) == "a:1");
+            }
+        }
+
+        WHEN("The output does not fit") {
+            auto [out, size] = stx::format_to_n(buffer, sizeof(buffer), "{}, {:>5}!", "Hello", 123);
+
+            THEN("Expecting a truncated output and the untruncated size") {
+                REQUIRE(size == 13u);
+                REQUIRE(out == buffer + sizeof(buffer));
+                REQUIRE(std::string_view(buffer, sizeof(buffer)) == "Hello,  ");
+            }
+        }
+    }
+
+    GIVEN("A zero sized buffer") {
+        WHEN("Formatting") {
+            auto [out, size] = stx::format_to_n(static_cast<char*>(nullptr), 0u, "{}", 12345);
+
+            THEN("Expecting nothing to be written") {
+                REQUIRE(out == nullptr);
+                REQUIRE(size == 5u);
+            }
+        }
+    }
+}
+
+SCENARIO("format into a fixed_string", "[stx::format::format_fixed]") {
+    GIVEN("A fixed capacity") {
+        WHEN("The output fits") {
+            auto r = stx::format_fixed<16>("{}:{}", "localhost", 8080);
+
+            THEN("Expecting the complete output") {
+                REQUIRE(r == "localhost:8080");
+                REQUIRE(std::strlen(r.c_str()) == r.size());
+            }
+        }
+
+        WHEN("The output does not fit") {
+            auto r = stx::format_fixed<4>("{}", 1234567);
+
+            THEN("Expecting a truncated, null-terminated output") {
+                REQUIRE(r == "1234");
+                REQUIRE(std::strlen(r.c_str()) == 4u);
+            }
+        }
+    }
+}
+
+SCENARIO("format produces identical results for all sink types", "[stx::format::format_to]") {
+    GIVEN("Padded and unpadded values") {
+        auto fmt = GENERATE("{}|{}|{}|{}", "{:>8}|{:_<8}|{:^8}|{:.^9}", "{: }|{: }|{:0}|{:<}");
+        std::string s = "std::string";
+        const char* cs = "c-string";
+
+        WHEN("Formatting into a string, a vector, a list and a char buffer") {
+            std::string r1;
+            stx::format_to(std::back_inserter(r1), fmt, s, cs, 42, std::string_view("view"));
+
+            std::vector<char> r2;
+            stx::format_to(std::back_inserter(r2), fmt, s, cs, 42, std::string_view("view"));
+
+            std::list<char> r3;
+            stx::format_to(std::back_inserter(r3), fmt, s, cs, 42, std::string_view("view"));
+
+            char r4[128];
+            auto r4_end = stx::format_to(r4, fmt, s, cs, 42, std::string_view("view"));
+
+            THEN("Expecting identical results") {
+                INFO("Format: " << fmt);
+                REQUIRE(r1 == std::string(r2.begin(), r2.end()));
+                REQUIRE(r1 == std::string(r3.begin(), r3.end()));
+                REQUIRE(r1 == std::string(r4, r4_end));
+            }
+        }
+    }
+
+    GIVEN("A null C string") {
+        const char* cs = nullptr;
+
+        THEN("It formats as an empty string") {
+            REQUIRE(stx::format("[{}]", cs) == "[]");
+            REQUIRE(stx::format("[{:>3}]", cs) == "[   ]");
+
+            std::string out;
+            stx::format_to(std::back_inserter(out), "[{}]", cs);
+            REQUIRE(out == "[]");
+        }
+    }
+}
+
+SCENARIO("format strings padded by display width", "[stx::format::format]") {
+    GIVEN("Non-ASCII strings") {
+        WHEN("Padding by byte size") {
+            auto r = stx::format("{:<6}|", "\xc3\xa4\xc3\xb6\xc3\xbc"); /* äöü */
+
+            THEN("Expecting the byte size to be used") {
+                REQUIRE(r == "\xc3\xa4\xc3\xb6\xc3\xbc|");
+            }
+        }
+
+        WHEN("Padding by display width") {
+            auto r1 = stx::format("{:<6w}|", "\xc3\xa4\xc3\xb6\xc3\xbc"); /* äöü */
+            auto r2 = stx::format("{:.>6w}|", "\xe6\x97\xa5\xe6\x9c\xac"); /* 日本 */
+            auto r3 = stx::format("{:-^8w}|", std::string("a\xf0\x9f\x98\x80" "b")); /* a😀b */
+            auto r4 = stx::format("{:<6w}|", "abc");
+            auto r5 = stx::format("{:w}|", "abc");
+            auto r6 = stx::format("{:ww}|", "abc");
+
+            THEN("Expecting code points to be counted, wide chars twice") {
+                REQUIRE(r1 == "\xc3\xa4\xc3\xb6\xc3\xbc   |");
+                REQUIRE(r2 == "..\xe6\x97\xa5\xe6\x9c\xac|");
+                REQUIRE(r3 == "--a\xf0\x9f\x98\x80" "b--|");
+                REQUIRE(r4 == "abc   |");
+                REQUIRE(r5 == "wabc|"); /* Fill-char `w`, as before the flag */
+                REQUIRE(r6 == "wabc|"); /* Fill-char `w` and flag */
+            }
+        }
+    }
+
+    GIVEN("Strings longer than a SIMD register") {
+        std::string ascii(40u, 'x');
+        std::string mixed = ascii + "\xc3\xa4" + ascii + "\xe6\x97\xa5" + ascii;
+
+        THEN("Expecting the display width to be computed for the whole string") {
+            REQUIRE(stx::format_impl::display_width(ascii) == 40u);
+            REQUIRE(stx::format_impl::display_width(mixed) == 123u);
+            REQUIRE(stx::format_impl::count_code_points(mixed) == 122u);
+            REQUIRE(stx::format("{:.<125w}", mixed) == mixed + "..");
+        }
+    }
+}
+
+SCENARIO("format ranges, tuples and optionals", "[stx::format::format]") {
+    GIVEN("Ranges") {
+        THEN("Expecting bracketed, comma separated elements by default") {
+            REQUIRE(stx::format("{}", std::vector<int>{1, 2, 3}) == "[1, 2, 3]");
+            REQUIRE(stx::format("{}", std::vector<int>{}) == "[]");
+            REQUIRE(stx::format("{}", std::list<std::string>{"a", "b"}) == "[a, b]");
+            REQUIRE(stx::format("{}", std::vector<bool>{true, false}) == "[true, false]");
+        }
+
+        THEN("Expecting options to control brackets, separator and element format") {
+            REQUIRE(stx::format("{:n}", std::vector<int>{1, 2}) == "1, 2");
+            REQUIRE(stx::format("{:s/}", std::vector<int>{1, 2}) == "[1/2]");
+            REQUIRE(stx::format("{:ns}", std::vector<int>{1, 2}) == "12");
+            REQUIRE(stx::format("{:n:>4}", std::vector<int>{1, 22}) == "   1,   22");
+            REQUIRE(stx::format("{:s | :0x}", std::vector<int>{10, 255}) == "[a | ff]");
+            REQUIRE(stx::format("{::n}", std::vector<std::vector<int>>{{1, 2}, {3}}) == "[1, 2, 3]");
+        }
+    }
+
+    GIVEN("Maps") {
+        THEN("Expecting key: value pairs in braces") {
+            REQUIRE(stx::format("{}", std::map<std::string, int>{{"a", 1}, {"b", 2}}) == "{a: 1, b: 2}");
+            REQUIRE(stx::format("{:n:0x}", std::map<int, int>{{10, 11}}) == "a: b");
+        }
+    }
+
+    GIVEN("Tuples and pairs") {
+        THEN("Expecting parenthesized elements") {
+            REQUIRE(stx::format("{}", std::make_tuple(1, "a", true)) == "(1, a, true)");
+            REQUIRE(stx::format("{}", std::make_pair(std::string("k"), 1.5)) == "(k, 1.5)");
+            REQUIRE(stx::format("{:n:_>3}", std::make_tuple(1, 2)) == "__1, __2");
+            REQUIRE(stx::format("{}", std::tuple<>()) == "()");
+        }
+    }
+
+    GIVEN("Optionals") {
+        THEN("Expecting the value, or none") {
+            REQUIRE(stx::format("{:>4}", std::optional<int>(12)) == "  12");
+            REQUIRE(stx::format("{:>5}", std::optional<int>()) == " none");
+            REQUIRE(stx::format("{}", std::vector<std::optional<int>>{1, std::nullopt}) == "[1, none]");
+        }
+    }
+
+    GIVEN("Bytes") {
+        const std::vector<std::byte> bytes{std::byte{0x0}, std::byte{0xab}, std::byte{0xff}};
+
+        THEN("Expecting hex digits") {
+            REQUIRE(stx::format("{}", std::byte{0x1f}) == "1f");
+            REQUIRE(stx::format("{}", bytes) == "00abff");
+            REQUIRE(stx::format("{:s :0X}", bytes) == "00 AB FF");
+            REQUIRE(stx::format("{:s, }", bytes) == "00, ab, ff");
+        }
+    }
+}
+
+SCENARIO("format long templates with few placeholders", "[stx::format::format]") {
+    GIVEN("Literal runs of all lengths around the vector width") {
+        THEN("Escapes and placeholders are found at every offset") {
+            for (std::size_t n = 0u; n < 70u; ++n) {
+                const auto text = std::string(n, 'a');
+                const auto tail = std::string(70u - n, 'b');
+
+                REQUIRE(stx::format(text + "{}" + tail, 1) == text + "1" + tail);
+                REQUIRE(stx::format(text + "{{" + tail, 1) == text + "{" + tail);
+                REQUIRE(stx::format(text + "}}" + tail, 1) == text + "}" + tail);
+                REQUIRE(stx::format(text + "{{ {} }}" + tail, 1) == text + "{ 1 }" + tail);
+                REQUIRE(stx::format(text + "}" + tail, 1) == text + tail);
+                REQUIRE(stx::format(text + "{", 1) == text);
+            }
+        }
+    }
+
+    GIVEN("A multi-KB template") {
+        std::string tmpl;
+        std::string expected;
+        for (auto i = 0; i < 64; ++i) {
+            tmpl += "<p>" + std::string(100u, 'x') + " {0} {{esc}}</p>\n";
+            expected += "<p>" + std::string(100u, 'x') + " 7 {esc}</p>\n";
+        }
+
+        THEN("Expecting all fields to be replaced") {
+            REQUIRE(stx::format(tmpl, 7) == expected);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/intern-pool.h"
+#include "stx/format.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+SCENARIO("Interning strings", "[stx::intern_pool]") {
+    GIVEN("An empty pool") {
+        stx::intern_pool pool(4u, 64u);
+
+        WHEN("Interning equal strings") {
+            auto a = pool.intern(std::string("token"));
+            auto b = pool.intern("token");
+            auto c = pool.intern("other");
+
+            THEN("Expecting the same view for equal strings") {
+                REQUIRE(a == "token");
+                REQUIRE(a.data() == b.data());
+                REQUIRE(c.data() != a.data());
+                REQUIRE(pool.size() == 2u);
+            }
+
+            THEN("Ids map to the interned strings") {
+                const auto id = pool.intern_id("token");
+                REQUIRE(pool.str(id).data() == a.data());
+                REQUIRE(pool.find("token") == id);
+                REQUIRE(!pool.find("missing"));
+            }
+        }
+
+        WHEN("Interning many and large strings") {
+            std::vector<std::string_view> views;
+            for (auto i = 0; i < 1000; ++i)
+                views.push_back(pool.intern(stx::format("string-{}", i)));
+            const auto large = pool.intern(std::string(1000u, 'x'));
+
+            THEN("Earlier views stay valid") {
+                for (auto i = 0; i < 1000; ++i)
+                    REQUIRE(views[i] == stx::format("string-{}", i));
+                REQUIRE(large == std::string(1000u, 'x'));
+                REQUIRE(pool.size() == 1001u);
+                REQUIRE(pool.bytes() >= 1000u + 1000u * 8u);
+            }
+        }
+
+        WHEN("Interning empty strings") {
+            auto e = pool.intern("");
+
+            THEN("Expecting an empty view") {
+                REQUIRE(e.empty());
+                REQUIRE(pool.str(pool.intern_id("")).empty());
+            }
+        }
+    }
+
+    GIVEN("A pool shared by multiple threads") {
+        stx::intern_pool pool;
+
+        WHEN("Interning overlapping strings concurrently") {
+            std::vector<std::vector<std::string_view>> results(4u);
+            std::vector<std::thread> threads;
+            for (auto t = 0; t < 4; ++t)
+                threads.emplace_back([&pool, &results, t] {
+                    for (auto i = 0; i < 2000; ++i)
+                        results[t].push_back(pool.intern(stx::format("token-{}", (i * (t + 1)) % 500)));
+                });
+            for (auto& t : threads)
+                t.join();
+
+            THEN("Each string is stored once") {
+                REQUIRE(pool.size() == 500u);
+                for (const auto& r : results)
+                    for (auto v : r)
+                        REQUIRE(pool.intern(v).data() == v.data());
+            }
+        }
+    }
+}
+
+SCENARIO("Splitting strings into interned tokens", "[stx::intern_pool]") {
+    GIVEN("Paths with repeating tokens") {
+        stx::intern_pool pool;
+        std::vector<std::vector<std::string_view>> parts;
+
+        for (auto i = 0; i < 10; ++i) {
+            auto path = stx::format("/usr/share/doc/pkg-{}/README", i % 2);
+            parts.push_back(stx::split_interned(pool, path, "/"));
+        }
+
+        THEN("Tokens are shared and outlive the input") {
+            REQUIRE(parts[0] == std::vector<std::string_view>{"usr", "share", "doc", "pkg-0", "README"});
+            REQUIRE(parts[3][3] == "pkg-1");
+            REQUIRE(parts[0][0].data() == parts[9][0].data());
+            REQUIRE(pool.size() == 6u);
+        }
+
+        THEN("Ids can be used instead of views") {
+            auto ids = stx::split_interned<std::vector<stx::intern_pool::id_type>>(pool, "a//b/a", "/", false);
+            REQUIRE(ids.size() == 4u);
+            REQUIRE(ids[0] == ids[3]);
+            REQUIRE(pool.str(ids[1]).empty());
+            REQUIRE(pool.str(ids[2]) == "b");
+        }
+    }
+}
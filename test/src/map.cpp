@@ -1,8 +1,13 @@
 #include <catch2/catch_all.hpp>
 
+#include <cstdint>
+#include <iterator>
 #include <map>
+#include <random>
+#include <string>
 #include <unordered_map>
 #include <type_traits>
+#include <vector>
 
 #include "stx/map.h"
 
@@ -85,3 +90,124 @@ SCENARIO("value_or returns the matching value if the key exists", "[stx::map::va
         }
     }
 }
+
+SCENARIO("value_or_batch looks up all keys", "[stx::map::value_or_batch]") {
+    GIVEN("A large unordered_map and keys including misses") {
+        std::unordered_map<int, long> m;
+        for (int i = 0; i < 100000; i += 2)
+            m.emplace(i, i * 10l);
+
+        std::vector<int> keys;
+        for (int i = 0; i < 1000; ++i)
+            keys.push_back((i * 7919) % 100003);
+
+        WHEN("Looking up the keys in batch") {
+            std::vector<long> result(keys.size());
+            auto end = stx::value_or_batch(m, keys, -1, result.begin());
+
+            THEN("Expecting the same results as value_or") {
+                REQUIRE(end == result.end());
+                for (std::size_t i = 0u; i < keys.size(); ++i)
+                    REQUIRE(result[i] == stx::value_or(m, keys[i], -1l));
+            }
+        }
+
+        WHEN("Looking up fewer keys than the prefetch distance") {
+            std::vector<long> result;
+            stx::value_or_batch(m, std::vector<int>{2, 3}, -1, std::back_inserter(result));
+
+            THEN("Expecting all keys to be looked up") {
+                REQUIRE(result == std::vector<long>{20, -1});
+            }
+        }
+    }
+
+    GIVEN("An unordered_map with string keys") {
+        std::unordered_map<std::string, int> m;
+        for (int i = 0; i < 1000; ++i)
+            m.emplace(std::to_string(i), i);
+
+        WHEN("Looking up keys in batch") {
+            std::vector<std::string> keys;
+            for (int i = 0; i < 2000; i += 3)
+                keys.push_back(std::to_string(i));
+
+            std::vector<int> result;
+            stx::value_or_batch(m, keys, -1, std::back_inserter(result));
+
+            THEN("Expecting the same results as value_or") {
+                REQUIRE(result.size() == keys.size());
+                for (std::size_t i = 0u; i < keys.size(); ++i)
+                    REQUIRE(result[i] == stx::value_or(m, keys[i], -1));
+            }
+        }
+    }
+
+    GIVEN("A std::map") {
+        std::map<std::string, int> m = {{"a", 1}, {"b", 2}};
+
+        WHEN("Looking up keys in batch") {
+            std::vector<int> result;
+            stx::value_or_batch(m, std::vector<std::string>{"b", "c", "a"}, 0, std::back_inserter(result));
+
+            THEN("Expecting plain lookups") {
+                REQUIRE(result == std::vector<int>{2, 0, 1});
+            }
+        }
+    }
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`. The tables are
+ * larger than common last level caches (4M entries, ~200 MiB). */
+TEST_CASE("value_or_batch benchmark", "[stx::map::value_or_batch][.benchmark]") {
+    constexpr std::size_t size = 1u << 22u;
+    constexpr std::size_t lookups = 1u << 16u;
+
+    std::mt19937_64 rng(42u);
+    std::vector<std::uint64_t> keys(lookups);
+    for (auto& key : keys)
+        key = rng() % (2u * size); /* About half are misses */
+
+    std::vector<long> result(lookups);
+
+    SECTION("Integer keys") {
+        std::unordered_map<std::uint64_t, long> m;
+        m.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            m.emplace(2u * i, static_cast<long>(i));
+
+        BENCHMARK("value_or loop") {
+            for (std::size_t i = 0u; i < lookups; ++i)
+                result[i] = stx::value_or(m, keys[i], -1l);
+            return result.back();
+        };
+
+        BENCHMARK("value_or_batch") {
+            stx::value_or_batch(m, keys, -1l, result.begin());
+            return result.back();
+        };
+    }
+
+    SECTION("String keys") {
+        std::unordered_map<std::string, long> m;
+        m.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            m.emplace("key-" + std::to_string(2u * i), static_cast<long>(i));
+
+        std::vector<std::string> string_keys;
+        string_keys.reserve(lookups);
+        for (const auto key : keys)
+            string_keys.push_back("key-" + std::to_string(key));
+
+        BENCHMARK("value_or loop") {
+            for (std::size_t i = 0u; i < lookups; ++i)
+                result[i] = stx::value_or(m, string_keys[i], -1l);
+            return result.back();
+        };
+
+        BENCHMARK("value_or_batch") {
+            stx::value_or_batch(m, string_keys, -1l, result.begin());
+            return result.back();
+        };
+    }
+}
@@ -0,0 +1,213 @@
+#include <catch2/catch_all.hpp>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "stx/map.h"
+#include "stx/static-map.h"
+
+namespace
+{
+
+enum class color { red, green, blue, black };
+
+constexpr auto status_codes = stx::make_static_map<std::string_view, int>({
+    {"ok", 200},
+    {"created", 201},
+    {"moved", 301},
+    {"bad request", 400},
+    {"not found", 404},
+    {"internal error", 500},
+});
+
+constexpr auto color_names = stx::make_static_map<color, std::string_view>({
+    {color::red, "red"},
+    {color::green, "green"},
+    {color::blue, "blue"},
+});
+
+template <std::size_t... _I>
+constexpr auto make_squares(std::index_sequence<_I...>)
+{
+    return stx::make_static_map<int, int>({{int(_I) * 7, int(_I * _I)}...});
+}
+
+constexpr auto squares = make_squares(std::make_index_sequence<300>());
+
+}
+
+/* Lookups are evaluated at compile time. */
+static_assert(status_codes.size() == 6u);
+static_assert(stx::value_or(status_codes, "ok", 0) == 200);
+static_assert(stx::value_or(status_codes, "not found", 0) == 404);
+static_assert(stx::value_or(status_codes, "teapot", 418) == 418);
+static_assert(status_codes.value_or("created", 0) == 201);
+static_assert(color_names.value_or(color::blue, "") == "blue");
+static_assert(!color_names.contains(color::black));
+static_assert(squares.value_or(7 * 299, 0) == 299 * 299);
+
+SCENARIO("static_map lookups", "[stx::static_map]") {
+    GIVEN("A string keyed static map") {
+        WHEN("Looking up all keys at runtime") {
+            THEN("Expecting every key to map to its value") {
+                for (const auto& [key, value] : status_codes) {
+                    REQUIRE(status_codes.contains(key));
+                    REQUIRE(*status_codes.find(key) == value);
+                }
+            }
+
+            THEN("Expecting std::string keys to work") {
+                const std::string key = "moved";
+                REQUIRE(stx::value_or(status_codes, key, -1) == 301);
+                REQUIRE(stx::value_or(status_codes, std::string("gone"), -1) == -1);
+            }
+        }
+
+        WHEN("Looking up unknown keys") {
+            THEN("Expecting the fallback value") {
+                REQUIRE(status_codes.find("") == nullptr);
+                REQUIRE(status_codes.find("OK") == nullptr);
+                REQUIRE(status_codes.find("not found ") == nullptr);
+            }
+        }
+
+        WHEN("Calling value_or with a lvalue fallback") {
+            const int fallback = -1;
+
+            THEN("Expecting a reference into the map") {
+                REQUIRE(std::is_same_v<const int&, decltype(stx::value_or(status_codes, "ok", fallback))>);
+                REQUIRE(&stx::value_or(status_codes, "ok", fallback) == status_codes.find("ok"));
+                REQUIRE(&stx::value_or(status_codes, "gone", fallback) == &fallback);
+            }
+        }
+    }
+
+    GIVEN("An integer keyed static map") {
+        WHEN("Looking up all keys and gaps") {
+            THEN("Expecting only keys to be found") {
+                for (int i = 0; i < 300 * 7; ++i) {
+                    if (i % 7 == 0)
+                        REQUIRE(squares.value_or(i, -1) == (i / 7) * (i / 7));
+                    else
+                        REQUIRE(!squares.contains(i));
+                }
+            }
+        }
+    }
+
+    GIVEN("A list of keys") {
+        const std::vector<std::string_view> keys = {"ok", "teapot", "not found", "moved"};
+
+        WHEN("Looking up the keys in batch") {
+            std::vector<int> result(keys.size());
+            stx::value_or_batch(status_codes, keys, -1, result.begin());
+
+            THEN("Expecting the same results as value_or") {
+                REQUIRE(result == std::vector<int>{200, -1, 404, 301});
+            }
+        }
+    }
+
+    GIVEN("A single entry static map") {
+        constexpr auto one = stx::make_static_map<int, int>({{42, 1}});
+
+        THEN("Expecting lookups to work") {
+            STATIC_REQUIRE(one.value_or(42, 0) == 1);
+            STATIC_REQUIRE(one.value_or(41, 0) == 0);
+        }
+    }
+}
+
+namespace
+{
+
+/* 100 distinct keys of 6 to 13 chars, substrings of a random text. */
+constexpr const char* key_text =
+    "kemubcrdlsbqgbcnnchcrnbsdhuusbssmbhbrejnerdsjrvfdssugldrwcsbtgpvrnykosoljhzfwyhcsjqpkxojtcdqnfykepnbvcyrszkkwltpszoccipw";
+
+template <std::size_t... _I>
+constexpr auto make_words(std::index_sequence<_I...>)
+{
+    return stx::make_static_map<std::string_view, int>({{std::string_view(key_text + _I, 6u + _I % 8u), int(_I)}...});
+}
+
+constexpr auto words = make_words(std::make_index_sequence<100>());
+
+}
+
+/* Not run by default, run using `stx-test "[.benchmark]"`.
+ *
+ * Note: libstdc++ searches unordered maps of up to 20 elements with
+ *       non-trivial hashes linearly, without hashing the key. */
+TEST_CASE("static_map benchmark", "[stx::static_map][.benchmark]") {
+    constexpr std::size_t lookups = 1u << 16u;
+
+    SECTION("Few string keys") {
+        const std::unordered_map<std::string_view, int> map(status_codes.begin(), status_codes.end());
+        const std::string_view names[] = {"ok", "created", "moved", "not found", "teapot", "gone"};
+
+        std::vector<std::string_view> keys;
+        for (std::size_t i = 0u; i < lookups; ++i)
+            keys.push_back(names[(i * 7u) % 6u]);
+
+        BENCHMARK("static_map") {
+            int sum = 0;
+            for (const auto& key : keys)
+                sum += stx::value_or(status_codes, key, -1);
+            return sum;
+        };
+
+        BENCHMARK("std::unordered_map") {
+            int sum = 0;
+            for (const auto& key : keys)
+                sum += stx::value_or(map, key, -1);
+            return sum;
+        };
+    }
+
+    SECTION("Many string keys") {
+        const std::unordered_map<std::string_view, int> map(words.begin(), words.end());
+
+        std::vector<std::string_view> keys;
+        for (std::size_t i = 0u; i < lookups; ++i)
+            keys.push_back(std::string_view(key_text + (i * 13u) % 110u, 6u + i % 5u)); /* Hits and misses */
+
+        BENCHMARK("static_map") {
+            int sum = 0;
+            for (const auto& key : keys)
+                sum += stx::value_or(words, key, -1);
+            return sum;
+        };
+
+        BENCHMARK("std::unordered_map") {
+            int sum = 0;
+            for (const auto& key : keys)
+                sum += stx::value_or(map, key, -1);
+            return sum;
+        };
+    }
+
+    SECTION("Integer keys") {
+        const std::unordered_map<int, int> map(squares.begin(), squares.end());
+
+        std::vector<int> keys;
+        for (std::size_t i = 0u; i < lookups; ++i)
+            keys.push_back(static_cast<int>((i * 13u) % (300u * 7u)));
+
+        BENCHMARK("static_map") {
+            int sum = 0;
+            for (const auto& key : keys)
+                sum += stx::value_or(squares, key, -1);
+            return sum;
+        };
+
+        BENCHMARK("std::unordered_map") {
+            int sum = 0;
+            for (const auto& key : keys)
+                sum += stx::value_or(map, key, -1);
+            return sum;
+        };
+    }
+}
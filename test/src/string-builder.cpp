@@ -0,0 +1,172 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/string-builder.h"
+#include "stx/format.h"
+#include "stx/string.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define STX_TEST_FILENO _fileno
+#else
+#define STX_TEST_FILENO fileno
+#endif
+
+SCENARIO("Building strings in chunks", "[stx::string_builder]") {
+    GIVEN("A builder with small chunks") {
+        stx::string_builder b(8u);
+        std::string expected;
+
+        WHEN("Appending across chunk boundaries") {
+            for (auto i = 0; i < 20; ++i) {
+                b.push_back('a');
+                b.append("0123456789", static_cast<std::size_t>(i % 11));
+                b.append(static_cast<std::size_t>(i % 5), '-');
+                b += "|";
+
+                expected.push_back('a');
+                expected.append("0123456789", static_cast<std::size_t>(i % 11));
+                expected.append(static_cast<std::size_t>(i % 5), '-');
+                expected += "|";
+            }
+
+            THEN("Expecting the appended content") {
+                REQUIRE(b.size() == expected.size());
+                REQUIRE(b.str() == expected);
+
+                std::string chunks;
+                b.for_each_chunk([&](std::string_view chunk) {
+                    REQUIRE(chunk.size() <= 8u);
+                    chunks += chunk;
+                });
+                REQUIRE(chunks == expected);
+            }
+
+            AND_WHEN("Clearing the builder") {
+                b.clear();
+                b.append("new");
+
+                THEN("Expecting only the new content") {
+                    REQUIRE(b.str() == "new");
+                }
+            }
+        }
+
+        WHEN("Using the builder as format_to and join_to sink") {
+            const std::vector<std::string> parts = {"alpha", "beta", "gamma"};
+
+            stx::format_to(std::back_inserter(b), "{}: {:>12}|", "key", "value");
+            stx::join_to(std::back_inserter(b), parts.begin(), parts.end(), ", ");
+
+            THEN("Expecting the same output as format and join") {
+                REQUIRE(b.str() == stx::format("{}: {:>12}|", "key", "value") +
+                                   stx::join(parts.begin(), parts.end(), ", "));
+            }
+        }
+    }
+
+    GIVEN("A builder with a partially filled chunk") {
+        stx::string_builder b(8u);
+        b.append("abc");
+
+        WHEN("Move constructing and appending to both") {
+            stx::string_builder moved(std::move(b));
+            moved.append("def");
+            b.append("xyz");
+
+            THEN("Expecting independent content") {
+                REQUIRE(moved.str() == "abcdef");
+                REQUIRE(b.str() == "xyz");
+            }
+        }
+
+        WHEN("Move assigning and appending to both") {
+            stx::string_builder moved(4u);
+            moved.append("old");
+            moved = std::move(b);
+            moved.append("def");
+            b.append("xyz");
+
+            THEN("Expecting independent content") {
+                REQUIRE(moved.str() == "abcdef");
+                REQUIRE(b.str() == "xyz");
+            }
+        }
+    }
+
+    GIVEN("A builder with content") {
+        stx::string_builder b(16u);
+        for (auto i = 0; i < 1000; ++i)
+            stx::format_to(std::back_inserter(b), "line {}\n", i);
+
+        WHEN("Writing to a file") {
+            auto* file = std::tmpfile();
+            REQUIRE(file != nullptr);
+            REQUIRE(b.write_to(STX_TEST_FILENO(file)));
+
+            THEN("Expecting the file to contain the content") {
+                std::string content(b.size(), '\0');
+                std::rewind(file);
+                REQUIRE(std::fread(&content[0], 1u, content.size(), file) == content.size());
+                REQUIRE(content == b.str());
+            }
+
+            std::fclose(file);
+        }
+    }
+
+    GIVEN("A builder flushed while building") {
+        stx::string_builder b(16u);
+        auto* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+
+        std::string expected;
+        for (auto i = 0; i < 1000; ++i) {
+            const auto line = stx::format("line {}\n", i);
+            expected += line;
+            b += line;
+            if (i % 10 == 0) {
+                REQUIRE(b.flush_to(STX_TEST_FILENO(file)));
+                REQUIRE(b.size() < 16u);
+            }
+        }
+
+        /* Exactly filling the current chunk */
+        b.append(16u - b.size() % 16u, '#');
+        expected.append(16u - expected.size() % 16u, '#');
+        REQUIRE(b.flush_to(STX_TEST_FILENO(file)));
+        REQUIRE(b.empty());
+
+        b += "end";
+        expected += "end";
+        REQUIRE(b.write_to(STX_TEST_FILENO(file)));
+
+        THEN("Expecting the file to contain all content in order") {
+            std::string content(expected.size(), '\0');
+            std::rewind(file);
+            REQUIRE(std::fread(&content[0], 1u, content.size(), file) == content.size());
+            REQUIRE(content == expected);
+            REQUIRE(b.str() == "end");
+        }
+
+        std::fclose(file);
+    }
+}
+
+SCENARIO("Joining to an output iterator", "[stx::string::join_to]") {
+    GIVEN("A list of strings") {
+        const std::vector<std::string_view> parts = {"a", "", "c"};
+
+        THEN("Expecting the same result as join") {
+            std::string out;
+            stx::join_to(std::back_inserter(out), parts.begin(), parts.end(), "/");
+            REQUIRE(out == "a//c");
+
+            char buffer[8];
+            auto end = stx::join_to(buffer, parts.begin(), parts.begin(), "/");
+            REQUIRE(end == buffer);
+        }
+    }
+}
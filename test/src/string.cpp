@@ -3,9 +3,29 @@
 #include "stx/string.h"
 
 #include <cstring>
+#include <memory_resource>
 
 using namespace std::string_literals;
 
+namespace
+{
+
+/* Container without allocator_type (like QList) */
+template <class _T>
+struct plain_list
+{
+    using value_type = _T;
+
+    void push_back(const _T& v)
+    {
+        items.push_back(v);
+    }
+
+    std::vector<_T> items;
+};
+
+}
+
 SCENARIO("split a string into parts", "[stx::string::split]") {
     GIVEN("An empty string") {
         WHEN("Called with '/' as separator (discard empty)") {
@@ -138,6 +158,97 @@ SCENARIO("split a string into parts", "[stx::string::split]") {
             REQUIRE(o.at(4) == "e");
         }
     }
+    GIVEN("A container without allocator") {
+        auto r = stx::split<plain_list<std::string>>("a//b/c", "/", false);
+
+        THEN("Expecting the parts to be appended") {
+            REQUIRE(r.items == std::vector<std::string>{"a", "", "b", "c"});
+        }
+    }
+}
+
+/* split_n and rsplit_n are usable at compile time. */
+static_assert(stx::split_n<2>("localhost:8080", ":")[0] == "localhost");
+static_assert(stx::split_n<2>("localhost:8080", ":")[1] == "8080");
+static_assert(stx::split_n<2>("a/b/c", "/")[1] == "b/c");
+static_assert(stx::rsplit_n<2>("a/b/c", "/")[0] == "a/b");
+static_assert(stx::split_n<3>("a", "/").count == 1u);
+
+SCENARIO("split a string into a fixed number of parts", "[stx::string::split_n]") {
+    GIVEN("A string with fewer delimiters than parts") {
+        auto r = stx::split_n<4>("a/b", "/");
+
+        THEN("Expecting the found parts only") {
+            REQUIRE(r.count == 2u);
+            REQUIRE(r[0] == "a");
+            REQUIRE(r[1] == "b");
+            REQUIRE(r[2].empty());
+        }
+    }
+
+    GIVEN("A string with more delimiters than parts") {
+        WHEN("Splitting from the left") {
+            auto [a, rest] = stx::split_n<2>("a//b/c", "/");
+
+            THEN("Expecting the remainder in the last part") {
+                REQUIRE(a == "a");
+                REQUIRE(rest == "b/c");
+            }
+        }
+
+        WHEN("Splitting from the right") {
+            auto [rest, c] = stx::rsplit_n<2>("a/b//c", "/");
+
+            THEN("Expecting the remainder in the first part") {
+                REQUIRE(rest == "a/b");
+                REQUIRE(c == "c");
+            }
+        }
+
+        WHEN("Keeping empty parts") {
+            auto r = stx::split_n<3>("/a//b", "/", false);
+            auto l = stx::rsplit_n<3>("a//b/", "/", false);
+
+            THEN("Expecting empty parts to count") {
+                REQUIRE(r.count == 3u);
+                REQUIRE(r[0] == "");
+                REQUIRE(r[1] == "a");
+                REQUIRE(r[2] == "/b");
+
+                REQUIRE(l.count == 3u);
+                REQUIRE(l[0] == "a/");
+                REQUIRE(l[1] == "b");
+                REQUIRE(l[2] == "");
+            }
+        }
+    }
+
+    GIVEN("Parts matching split") {
+        const std::string_view inputs[] = {"", "/", "a", "a/b/c", "/a//b/", "//", "x/y"};
+
+        THEN("Expecting the same parts as split, if not limited") {
+            for (auto in : inputs) {
+                for (auto removeEmpty : {true, false}) {
+                    const auto expected = stx::split<std::vector<std::string_view>>(in, "/", removeEmpty);
+                    const auto left = stx::split_n<8>(in, "/", removeEmpty);
+                    const auto right = stx::rsplit_n<8>(in, "/", removeEmpty);
+
+                    REQUIRE(std::vector<std::string_view>(left.begin(), left.end()) == expected);
+                    REQUIRE(std::vector<std::string_view>(right.begin(), right.end()) == expected);
+                }
+            }
+        }
+    }
+
+    GIVEN("A multi-char delimiter") {
+        auto r = stx::rsplit_n<2>("key::sub::value", "::");
+
+        THEN("Expecting it to split at the last occurrence") {
+            REQUIRE(r.count == 2u);
+            REQUIRE(r[0] == "key::sub");
+            REQUIRE(r[1] == "value");
+        }
+    }
 }
 
 SCENARIO("join a range of strings together", "[stx::string::join]") {
@@ -316,3 +427,70 @@ TEST_CASE("Get tuple values as string", "[stx::string::get_as_string]") {
         REQUIRE(r4 == "1");
     }
 }
+
+TEST_CASE("Allocator-aware string functions", "[stx::string::pmr]") {
+    std::pmr::monotonic_buffer_resource arena;
+
+    SECTION("split") {
+        auto r = stx::split<std::pmr::vector<std::pmr::string>>("a/b/c", "/", true, &arena);
+
+        REQUIRE(r.size() == 3);
+        REQUIRE(r.get_allocator().resource() == &arena);
+        REQUIRE(r.at(2) == "c");
+        REQUIRE(r.at(2).get_allocator().resource() == &arena);
+    }
+
+    SECTION("join") {
+        auto range = std::vector<std::string_view> {"A", "B", "C"};
+        auto r = stx::join<std::pmr::string>(std::allocator_arg, &arena, range.begin(), range.end(), "/");
+
+        REQUIRE(r == "A/B/C");
+        REQUIRE(r.get_allocator().resource() == &arena);
+    }
+
+    SECTION("to_string") {
+        auto r1 = stx::to_string<std::pmr::string>(std::allocator_arg, &arena, 123);
+        auto r2 = stx::to_string<std::pmr::string>(std::allocator_arg, &arena, "Test");
+
+        REQUIRE(r1 == "123");
+        REQUIRE(r1.get_allocator().resource() == &arena);
+        REQUIRE(r2 == "Test");
+        REQUIRE(r2.get_allocator().resource() == &arena);
+    }
+
+    SECTION("replace_with") {
+        auto r = stx::replace_with(std::pmr::string("? and ?", &arena), "?", 1, "two");
+
+        REQUIRE(r == "1 and two");
+        REQUIRE(r.get_allocator().resource() == &arena);
+    }
+
+    SECTION("to_hex") {
+        auto vec = std::vector<std::uint8_t> {0x0, 0xff};
+        auto r = stx::to_hex<std::pmr::string>(std::allocator_arg, &arena, vec.begin(), vec.end());
+
+        REQUIRE(r == "00ff");
+        REQUIRE(r.get_allocator().resource() == &arena);
+    }
+}
+
+TEST_CASE("Explicit template arguments", "[stx::string]") {
+    SECTION("to_string") {
+        const int v = 42;
+        REQUIRE(stx::to_string<const int&>(v) == "42");
+    }
+
+    SECTION("join") {
+        auto range = std::vector<std::string> {"A", "B"};
+        REQUIRE(stx::join<std::vector<std::string>::iterator>(range.begin(), range.end(), "/") == "A/B");
+    }
+
+    SECTION("get_as_string") {
+        REQUIRE(stx::get_as_string<std::tuple<int, bool>>(1u, std::make_tuple(1, true)) == "1");
+    }
+
+    SECTION("to_hex") {
+        auto vec = std::vector<std::uint8_t> {0xab};
+        REQUIRE(stx::to_hex<std::vector<std::uint8_t>::iterator>(vec.begin(), vec.end(), true) == "AB");
+    }
+}
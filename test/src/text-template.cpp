@@ -0,0 +1,134 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/text-template.h"
+
+#include <string>
+#include <vector>
+
+using change = stx::text_template::change;
+
+SCENARIO("Rendering text templates incrementally", "[stx::text_template]") {
+    GIVEN("A template with named placeholders") {
+        stx::text_template t("CPU: {cpu}% | RAM: {ram}% | CPU again: {cpu}%");
+
+        THEN("Placeholders render empty until set") {
+            REQUIRE(t.str() == "CPU: % | RAM: % | CPU again: %");
+            REQUIRE(t.contains("cpu"));
+            REQUIRE(!t.contains("disk"));
+            REQUIRE(t.changes().empty());
+        }
+
+        WHEN("Setting values") {
+            REQUIRE(t.set("cpu", 12));
+            REQUIRE(t.set("ram", "80"));
+            REQUIRE(!t.set("disk", 1));
+
+            THEN("All occurrences are replaced") {
+                REQUIRE(t.str() == "CPU: 12% | RAM: 80% | CPU again: 12%");
+                REQUIRE(t.get("cpu") == "12");
+                REQUIRE(t.changes() == std::vector<change>{{5, 0, 2}, {31, 0, 2}, {16, 0, 2}});
+            }
+
+            AND_WHEN("Changing a value with the same size") {
+                t.clear_changes();
+                t.set("cpu", 13);
+
+                THEN("Only its bytes change") {
+                    REQUIRE(t.str() == "CPU: 13% | RAM: 80% | CPU again: 13%");
+                    REQUIRE(t.changes() == std::vector<change>{{5, 2, 2}, {33, 2, 2}});
+                }
+            }
+
+            AND_WHEN("Changing a value with a different size") {
+                t.clear_changes();
+                t.set("cpu", 100);
+                t.set("ram", std::string("7"));
+
+                THEN("Following segments are shifted") {
+                    REQUIRE(t.str() == "CPU: 100% | RAM: 7% | CPU again: 100%");
+                    REQUIRE(t.changes() == std::vector<change>{{5, 2, 3}, {34, 2, 3}, {17, 2, 1}});
+                }
+            }
+
+            AND_WHEN("Setting an unchanged value") {
+                t.clear_changes();
+                t.set("ram", 80);
+
+                THEN("Nothing changes") {
+                    REQUIRE(t.changes().empty());
+                }
+            }
+        }
+    }
+
+    GIVEN("A template with escaped and unmatched braces") {
+        stx::text_template t("{{literal}} {a}{b} { } {");
+        t.set("a", "A");
+        t.set("b", "B");
+
+        THEN("Expecting the escapes to be kept") {
+            REQUIRE(t.str() == "{literal} AB  {");
+        }
+
+        THEN("A space between braces is a placeholder name") {
+            REQUIRE(t.contains(" "));
+        }
+    }
+
+    GIVEN("A template with many adjacent occurrences") {
+        std::string source;
+        for (int i = 0; i < 50; ++i)
+            source += "{x}-{y}{x}|";
+        stx::text_template t(source);
+
+        auto render = [](std::string_view x, std::string_view y) {
+            std::string text;
+            for (int i = 0; i < 50; ++i)
+                text.append(x).append("-").append(y).append(x).append("|");
+            return text;
+        };
+
+        WHEN("Growing and shrinking the values") {
+            const std::vector<std::string> values = {"abc", "a", "", "abcdefgh", "xy", "xy", "abcdefghijk", "q"};
+
+            THEN("Expecting the same text as rendering from scratch") {
+                std::string x, y;
+                for (const auto& v : values) {
+                    t.set("x", v);
+                    x = v;
+                    REQUIRE(t.str() == render(x, y));
+
+                    t.set("y", v + v);
+                    y = v + v;
+                    REQUIRE(t.str() == render(x, y));
+                }
+            }
+        }
+
+        WHEN("Setting a value taken from the rendered text") {
+            t.set("x", "abc");
+            t.set("y", std::string_view(t.str()).substr(0u, 2u));
+
+            THEN("Expecting the value to be copied first") {
+                REQUIRE(t.str() == render("abc", "ab"));
+            }
+        }
+
+        WHEN("Applying the recorded changes to a copy of the text") {
+            t.set("x", "12");
+            auto copy = t.str();
+            t.clear_changes();
+            t.set("x", "12345");
+            t.set("y", "z");
+
+            THEN("Expecting the same text") {
+                std::size_t index = 0u;
+                for (const auto& c : t.changes()) {
+                    const auto value = index++ < 100u ? "12345" : "z";
+                    copy.replace(c.offset, c.old_size, value, c.size);
+                }
+                REQUIRE(copy == t.str());
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_all.hpp>
+
+#include "stx/tuple-visit.h"
+#include "stx/format.h"
+#include "stx/string.h"
+
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+
+template <std::size_t... _I>
+constexpr auto make_numbers(std::index_sequence<_I...>)
+{
+    return std::make_tuple(static_cast<int>(_I)...);
+}
+
+/* 64 ints 0 ... 63 */
+constexpr auto numbers = make_numbers(std::make_index_sequence<64>());
+
+/* Format string "{} {} ... {}" for `n` placeholders */
+std::string placeholders(std::size_t n)
+{
+    std::string fmt;
+    for (std::size_t i = 0u; i < n; ++i)
+        fmt += i ? " {}" : "{}";
+    return fmt;
+}
+
+}
+
+/* Dispatch works at compile time. */
+static_assert(stx::visit_at(0u, numbers, [](int v) { return v * 2; }) == 0);
+static_assert(stx::visit_at(63u, numbers, [](int v) { return v * 2; }) == 126);
+
+SCENARIO("Visiting tuple elements by runtime index", "[stx::visit_at]") {
+    GIVEN("A tuple of mixed types") {
+        auto t = std::make_tuple(1, std::string("two"), 3.5, 'c');
+
+        THEN("Expecting the element at the index to be visited") {
+            REQUIRE(stx::visit_at(1u, t, [](const auto& v) { return stx::format("{}", v); }) == "two");
+            REQUIRE(stx::visit_at(2u, t, [](const auto& v) { return stx::format("{}", v); }) == "3.5");
+        }
+
+        THEN("Expecting elements to be modifiable") {
+            stx::visit_at(0u, t, [](auto& v) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(v)>, int>)
+                    v = 42;
+            });
+            REQUIRE(std::get<0>(t) == 42);
+        }
+    }
+
+    GIVEN("A tuple of 64 elements") {
+        THEN("Expecting each index to visit its element") {
+            for (std::size_t i = 0u; i < 64u; ++i)
+                REQUIRE(stx::visit_at(i, numbers, [](int v) { return v; }) == static_cast<int>(i));
+        }
+
+        THEN("Expecting format to handle 64 arguments") {
+            const auto fmt = placeholders(64u);
+            const auto result = std::apply([&](const auto& ...args) {
+                return stx::format(fmt, args...);
+            }, numbers);
+
+            std::string expected;
+            for (int i = 0; i < 64; ++i)
+                expected += (i ? " " : "") + std::to_string(i);
+            REQUIRE(result == expected);
+
+            REQUIRE(std::apply([](const auto& ...args) {
+                return stx::format("{63}|{0}|{31}|{64}", args...);
+            }, numbers) == "63|0|31|");
+        }
+
+        THEN("Expecting get_as_string to handle 64 elements") {
+            for (std::size_t i = 0u; i < 64u; ++i)
+                REQUIRE(stx::get_as_string(i, numbers) == std::to_string(i));
+            REQUIRE(stx::get_as_string(64u, numbers).empty());
+        }
+    }
+
+    GIVEN("An empty tuple") {
+        THEN("Expecting out of range results") {
+            REQUIRE(stx::get_as_string(0u, std::tuple<>()).empty());
+            REQUIRE(stx::format("{}|{}", "a") == "a|");
+        }
+    }
+}